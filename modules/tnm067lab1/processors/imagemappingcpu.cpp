@@ -1,9 +1,13 @@
 #include <modules/tnm067lab1/processors/imagemappingcpu.h>
+#include <modules/tnm067lab1/utils/parallel.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/tracer.h>
 #include <inviwo/core/common/inviwoapplication.h>
 #include <inviwo/core/datastructures/image/layerramprecision.h>
 #include <inviwo/core/util/indexmapper.h>
-#include <inviwo/core/util/imageramutils.h>
+
+#include <limits>
+#include <type_traits>
 
 
 namespace inviwo {
@@ -32,7 +36,9 @@ ImageMappingCPU::ImageMappingCPU()
                FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
                FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
                FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
-               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}})
+    , useLookupTable_("useLookupTable", "Use Lookup Table", false)
+    , lookupTableSize_("lookupTableSize", "Lookup Table Size", 4096, 2, 65536) {
 
     addPort(inport_);
     addPort(outport_);
@@ -52,9 +58,14 @@ ImageMappingCPU::ImageMappingCPU()
 
     numColors_.onChange(colorVisibility);
     colorVisibility();
+
+    addProperty(useLookupTable_);
+    addProperty(lookupTableSize_);
+    lookupTableSize_.visibilityDependsOn(useLookupTable_, [](auto& p) { return p.get(); });
 }
 
 void ImageMappingCPU::process() {
+    ScopedTimer timer("ImageMappingCPU::process");
     auto inImg = inport_.getData();
     auto img = std::make_shared<Image>(inImg->getDimensions(), DataVec4UInt8::get());
     auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
@@ -66,16 +77,57 @@ void ImageMappingCPU::process() {
     for (size_t i = 0; i < numColors_.get(); i++) {
         map.addBaseColors(colors_[i].get());
     }
+    if (useLookupTable_) {
+        map.setLookupTableSize(lookupTableSize_);
+    }
 
+    const size2_t dims = inImg->getDimensions();
     inImg->getColorLayer()->getRepresentation<LayerRAM>()->dispatch<void>([&](const auto inRep) {
+        using ValueType = util::PrecisionValueType<decltype(inRep)>;
         auto inPixels = inRep->getDataTyped();
-        util::forEachPixelParallel(*inRep, [&](size2_t pos) {
-            auto i = index(pos);
-            float inPixelVal = util::glm_convert_normalized<float>(inPixels[i]);
-            outPixels[i] = map.sample(inPixelVal) * 255.f;
-        });
+
+        if constexpr (std::is_same_v<ValueType, glm::u8> || std::is_same_v<ValueType, glm::u16>) {
+            // The color only depends on the integer value, precompute it for every possible
+            // value and turn the mapping into a plain table gather
+            const size_t numValues = size_t{std::numeric_limits<ValueType>::max()} + 1;
+            std::vector<float> values(numValues);
+            std::vector<vec4> colors(numValues);
+            for (size_t v = 0; v < numValues; ++v) {
+                values[v] = util::glm_convert_normalized<float>(static_cast<ValueType>(v));
+            }
+            map.sampleBatch(values, colors);
+            std::vector<glm::u8vec4> table(numValues);
+            for (size_t v = 0; v < numValues; ++v) {
+                table[v] = colors[v] * 255.f;
+            }
+
+            util::forEachIndexParallel(dims.y, [&](size_t y) {
+                const size_t offset = index(size2_t(0, y));
+                for (size_t x = 0; x < dims.x; ++x) {
+                    outPixels[offset + x] = table[inPixels[offset + x]];
+                }
+            });
+        } else {
+            // Map whole rows at a time, the row buffers are allocated once per range of rows
+            util::forEachRangeParallel(dims.y, [&](size_t yBegin, size_t yEnd) {
+                std::vector<float> values(dims.x);
+                std::vector<vec4> colors(dims.x);
+                for (size_t y = yBegin; y < yEnd; ++y) {
+                    const size_t offset = index(size2_t(0, y));
+                    for (size_t x = 0; x < dims.x; ++x) {
+                        values[x] = util::glm_convert_normalized<float>(inPixels[offset + x]);
+                    }
+                    map.sampleBatch(values, colors);
+                    for (size_t x = 0; x < dims.x; ++x) {
+                        outPixels[offset + x] = colors[x] * 255.f;
+                    }
+                }
+            });
+        }
     });
 
+    Tracer::get().addCounter("ImageMappingCPU pixels mapped",
+                             static_cast<int64_t>(dims.x * dims.y));
     outport_.setData(img);
 }
 
@@ -3,6 +3,7 @@
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/boolproperty.h>
 #include <inviwo/core/ports/imageport.h>
 
 namespace inviwo {
@@ -23,6 +24,9 @@ private:
 
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
+
+    BoolProperty useLookupTable_;
+    IntSizeTProperty lookupTableSize_;
 };
 
 }  // namespace inviwo
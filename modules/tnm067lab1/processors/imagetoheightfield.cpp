@@ -1,7 +1,17 @@
 #include <modules/tnm067lab1/processors/imagetoheightfield.h>
+#include <modules/tnm067lab1/utils/parallel.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
-#include <inviwo/core/util/imageramutils.h>
+#include <modules/tnm067lab1/utils/tracer.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/util/glmutils.h>
 #include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <optional>
 
 namespace inviwo {
 
@@ -19,7 +29,17 @@ ImageToHeightfield::ImageToHeightfield()
     : Processor()
     , imageInport_("imageInport", true)
     , meshOutport_("meshOutport")
+    , chunksOutport_("chunksOutport")
+    , meshMode_("meshMode", "Mesh Mode",
+                {{"bars", "Bars", MeshMode::Bars},
+                 {"surface", "Surface", MeshMode::Surface},
+                 {"chunkedSurface", "Chunked Surface", MeshMode::ChunkedSurface}})
     , heightScaleFactor_("heightScaleFactor", "Height Scale Factor", 1.0f, 0.001f, 2.0f, 0.001f)
+    , chunkSize_("chunkSize", "Chunk Size",
+                 {{"64", "64", 64}, {"128", "128", 128}, {"256", "256", 256}, {"512", "512", 512}},
+                 2)
+    , errorTolerance_("errorTolerance", "Error Tolerance (Fraction of Value Range)", 0.01f, 0.0f,
+                      0.25f, 0.001f)
     , numColors_("numColors", "Number of colors", 2, 1, 10)
     , colors_(
           {FloatVec4Property{"color1", "Color 1", util::ordinalColor(0.0f, 0.0f, 0.0f, 1.0f)},
@@ -35,7 +55,15 @@ ImageToHeightfield::ImageToHeightfield()
 
     addPort(imageInport_);
     addPort(meshOutport_);
+    addPort(chunksOutport_);
+    addProperty(meshMode_);
     addProperty(heightScaleFactor_);
+    addProperty(chunkSize_);
+    addProperty(errorTolerance_);
+
+    auto isChunked = [](auto& p) { return p.get() == MeshMode::ChunkedSurface; };
+    chunkSize_.visibilityDependsOn(meshMode_, isChunked);
+    errorTolerance_.visibilityDependsOn(meshMode_, isChunked);
 
     addProperty(numColors_);
     for (auto& c : colors_) {
@@ -50,95 +78,577 @@ ImageToHeightfield::ImageToHeightfield()
 
     numColors_.onChange(colorVisibility);
     colorVisibility();
+
+    // The height scale is applied as a model matrix and does not invalidate anything, a changed
+    // error tolerance only rebuilds chunks whose level of detail changes
+    imageInport_.onChange([this]() {
+        geometry_.reset();
+        chunksOutdated_ = true;
+    });
+    meshMode_.onChange([this]() { geometry_.reset(); });
+    chunkSize_.onChange([this]() {
+        chunks_.clear();
+        chunksOutdated_ = true;
+    });
+    auto invalidateColors = [this]() {
+        colorBuffer_.reset();
+        for (auto& chunk : chunks_) chunk.colorBuffer.reset();
+    };
+    numColors_.onChange(invalidateColors);
+    for (auto& c : colors_) {
+        c.onChange(invalidateColors);
+    }
 }
 
 namespace {
-using HFMesh = TypedMesh<buffertraits::PositionsBuffer, buffertraits::NormalBuffer,
-                         buffertraits::ColorsBuffer>;
+/*
+ * Raw views into the buffers of a geometry whose final size is known up front. Every face is a
+ * quad of four vertices and six indices, face number i is written to vertices [4i, 4i + 4) and
+ * indices [6i, 6i + 6). Different faces can therefore be written concurrently.
+ */
+struct GeometryWriter {
+    GeometryWriter(ImageToHeightfield::Geometry& geometry, size_t numVertices, size_t numIndices) {
+        geometry.positions = std::make_shared<Buffer<vec3>>(numVertices);
+        geometry.normals = std::make_shared<Buffer<vec3>>(numVertices);
+        geometry.indices = std::make_shared<IndexBuffer>(numIndices);
+        geometry.vertexValues.resize(numVertices);
 
-void addFace(std::vector<HFMesh::Vertex>& vertices, std::vector<unsigned int>& indices,
-             const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4, const vec3& normal,
-             const vec4& color) {
+        positions = geometry.positions->getEditableRAMRepresentation()->getDataContainer().data();
+        normals = geometry.normals->getEditableRAMRepresentation()->getDataContainer().data();
+        indices = geometry.indices->getEditableRAMRepresentation()->getDataContainer().data();
+        values = geometry.vertexValues.data();
+    }
+
+    void setVertex(size_t i, const vec3& position, const vec3& normal, float value) const {
+        positions[i] = position;
+        normals[i] = normal;
+        values[i] = value;
+    }
 
-    unsigned int startID = static_cast<unsigned int>(vertices.size());
-    vertices.emplace_back(c1, normal, color);
-    vertices.emplace_back(c2, normal, color);
-    vertices.emplace_back(c3, normal, color);
-    vertices.emplace_back(c4, normal, color);
+    void addFace(size_t face, const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                 const vec3& normal, float value) const {
+        const size_t startID = 4 * face;
+        setVertex(startID + 0, c1, normal, value);
+        setVertex(startID + 1, c2, normal, value);
+        setVertex(startID + 2, c3, normal, value);
+        setVertex(startID + 3, c4, normal, value);
 
-    indices.insert(indices.end(),
-                   {startID + 0, startID + 1, startID + 2, startID + 0, startID + 2, startID + 3});
-}
+        const auto v = static_cast<std::uint32_t>(startID);
+        std::uint32_t* i = indices + 6 * face;
+        i[0] = v + 0;
+        i[1] = v + 1;
+        i[2] = v + 2;
+        i[3] = v + 0;
+        i[4] = v + 2;
+        i[5] = v + 3;
+    }
+
+    vec3* positions;
+    vec3* normals;
+    std::uint32_t* indices;
+    float* values;
+};
 
-std::shared_ptr<Mesh> buildMesh(const LayerRAM& image, const ScalarToColorMapping& map,
-                                float scaleFactor) {
+// The first component of every pixel, read through the typed representation
+std::vector<float> readImageValues(const LayerRAM& image) {
     const auto dims = image.getDimensions();
+    std::vector<float> imageValues(dims.x * dims.y);
+    image.dispatch<void>([&](const auto rep) {
+        const auto pixels = rep->getDataTyped();
+        util::forEachIndexParallel(dims.y, [&](size_t y) {
+            for (size_t i = y * dims.x; i < (y + 1) * dims.x; ++i) {
+                imageValues[i] = static_cast<float>(util::glmcomp(pixels[i], 0));
+            }
+        });
+    });
+    return imageValues;
+}
+
+// The geometry is built with a height scale of one, i.e. heights equal the image values
+struct HeightField {
+    size2_t dims;
+    const std::vector<float>& values;
+
+    size_t index(size_t x, size_t y) const { return x + y * dims.x; }
+    float value(size_t x, size_t y) const { return values[index(x, y)]; }
+    // Height of the bar at (x, y), zero outside of the image
+    float height(size_t x, size_t y) const {
+        if (x >= dims.x || y >= dims.y) return 0.0f;
+        return value(x, y);
+    }
+    vec2 cellSize() const { return 1.0f / vec2(dims); }
+};
+
+// A vertical piece of a bar side, lo and hi are heights and value is the image value that
+// determines the color
+struct SideSegment {
+    float lo;
+    float hi;
+    float value;
 
-    auto mesh = std::make_shared<HFMesh>();
-    auto& indices =
-        mesh->addIndexBuffer(DrawType::Triangles, ConnectivityType::None)->getDataContainer();
-
-    std::vector<HFMesh::Vertex> vertices;
-
-    const auto bufferSize = 24 * dims.x * dims.y;
-    indices.reserve(bufferSize);
-    vertices.reserve(bufferSize);
-
-    const vec2 cellSize = 1.0f / vec2(dims);
-    util::forEachPixel(image, [&](const size2_t& pos) {
-        const vec2 origin2D = vec2(pos) * cellSize;
-        const vec3 origin(origin2D.x, 0.0f, origin2D.y);
-
-        const float imageValue = image.getAsDouble(pos);  //Img value at pos
-
-        const vec4 color = map.sample(imageValue);
-
-        const float height = imageValue * scaleFactor;  //Added scale factor
-
-        // Box Corners
-        const auto zero = origin + vec3(0.0f, 0.0f, 0.0f);
-        const auto px = origin + vec3(cellSize.x, 0.0f, 0.0f);
-        const auto pz = origin + vec3(0.0f, 0.0f, cellSize.y);
-        const auto py = origin + vec3(0.0f, height, 0.0f);
-        const auto pxpy = origin + vec3(cellSize.x, height, 0.0f);
-        const auto pxpz = origin + vec3(cellSize.x, 0.0f, cellSize.y);
-        const auto pypz = origin + vec3(0.0f, height, cellSize.y);
-        const auto pxpypz = origin + vec3(cellSize.x, height, cellSize.y);
-
-        // Box Normals
-        constexpr auto down = vec3(0.0f, -1.0f, 0.0f);
-        constexpr auto up = vec3(0.0f, 1.0f, 0.0f);
-        constexpr auto left = vec3(-1.0f, 0.0f, 0.0f);
-        constexpr auto right = vec3(1.0f, 0.0f, 0.0f);
-        constexpr auto front = vec3(0.0f, 0.0f, -1.0f);
-        constexpr auto back = vec3(0.0f, 0.0f, 1.0f);
-
-        addFace(vertices, indices, zero, px, pxpz, pz, down, color);       // Bottom face
-        addFace(vertices, indices, py, pxpy, pxpypz, pypz, up, color);     // Top face
-        addFace(vertices, indices, zero, pz, pypz, py, left, color);       // Left face
-        addFace(vertices, indices, px, pxpz, pxpypz, pxpy, right, color);  // Right face
-        addFace(vertices, indices, zero, px, pxpy, py, front, color);      // Front face
-        addFace(vertices, indices, pz, pxpz, pxpypz, pypz, back, color);   // Back face
+    bool operator==(const SideSegment& rhs) const {
+        return lo == rhs.lo && hi == rhs.hi && value == rhs.value;
+    }
+    bool operator!=(const SideSegment& rhs) const { return !(*this == rhs); }
+};
+
+/*
+ * The parts of the side of a bar with height a that are not covered by the neighbouring bar
+ * with height b. Bars span from zero to their height, the first element is the exposed part
+ * below the neighbour and the second element the exposed part above it.
+ */
+std::array<std::optional<SideSegment>, 2> exposedSide(float a, float b, float value) {
+    const float aLo = std::min(0.0f, a);
+    const float aHi = std::max(0.0f, a);
+    const float bLo = std::min(0.0f, b);
+    const float bHi = std::max(0.0f, b);
+
+    std::array<std::optional<SideSegment>, 2> res;
+    if (aLo < bLo) res[0] = SideSegment{aLo, std::min(aHi, bLo), value};
+    if (aHi > bHi) res[1] = SideSegment{std::max(aLo, bHi), aHi, value};
+    return res;
+}
+
+// Calls emit(begin, end, segment) for every run of equal, non empty segments in [0, count)
+template <typename SegmentAt, typename Emit>
+void forEachRun(size_t count, SegmentAt segmentAt, Emit emit) {
+    size_t begin = 0;
+    for (size_t i = 1; i <= count; ++i) {
+        if (i == count || segmentAt(i) != segmentAt(begin)) {
+            if (const auto segment = segmentAt(begin)) emit(begin, i, *segment);
+            begin = i;
+        }
+    }
+}
+
+/*
+ * Calls emit(c1, c2, c3, c4, normal, value) for the visible side faces along one grid line.
+ * Lines [0, dims.x] are at constant x and lines [dims.x + 1, dims.x + dims.y + 1] at constant z.
+ * Only the parts of a bar side that are not hidden by the neighbouring bar are emitted, runs of
+ * identical segments along the line are merged into one face.
+ */
+template <typename Emit>
+void forEachSideFace(const HeightField& hf, size_t line, Emit emit) {
+    constexpr auto left = vec3(-1.0f, 0.0f, 0.0f);
+    constexpr auto right = vec3(1.0f, 0.0f, 0.0f);
+    constexpr auto front = vec3(0.0f, 0.0f, -1.0f);
+    constexpr auto back = vec3(0.0f, 0.0f, 1.0f);
+
+    const vec2 cellSize = hf.cellSize();
+    auto corner = [&](size_t x, float height, size_t z) {
+        return vec3(x * cellSize.x, height, z * cellSize.y);
+    };
+
+    for (size_t layer = 0; layer < 2; ++layer) {
+        if (line <= hf.dims.x) {
+            const size_t bx = line;
+            auto addSide = [&](size_t begin, size_t end, const SideSegment& s, const vec3& n) {
+                emit(corner(bx, s.lo, begin), corner(bx, s.lo, end), corner(bx, s.hi, end),
+                     corner(bx, s.hi, begin), n, s.value);
+            };
+            if (bx > 0) {  // Right faces of the bars left of the grid line
+                forEachRun(
+                    hf.dims.y,
+                    [&](size_t y) {
+                        return exposedSide(hf.height(bx - 1, y), hf.height(bx, y),
+                                           hf.value(bx - 1, y))[layer];
+                    },
+                    [&](size_t begin, size_t end, const SideSegment& s) {
+                        addSide(begin, end, s, right);
+                    });
+            }
+            if (bx < hf.dims.x) {  // Left faces of the bars right of the grid line
+                forEachRun(
+                    hf.dims.y,
+                    [&](size_t y) {
+                        return exposedSide(hf.height(bx, y), bx > 0 ? hf.height(bx - 1, y) : 0.0f,
+                                           hf.value(bx, y))[layer];
+                    },
+                    [&](size_t begin, size_t end, const SideSegment& s) {
+                        addSide(begin, end, s, left);
+                    });
+            }
+        } else {
+            const size_t by = line - hf.dims.x - 1;
+            auto addSide = [&](size_t begin, size_t end, const SideSegment& s, const vec3& n) {
+                emit(corner(begin, s.lo, by), corner(end, s.lo, by), corner(end, s.hi, by),
+                     corner(begin, s.hi, by), n, s.value);
+            };
+            if (by > 0) {  // Back faces of the bars in front of the grid line
+                forEachRun(
+                    hf.dims.x,
+                    [&](size_t x) {
+                        return exposedSide(hf.height(x, by - 1), hf.height(x, by),
+                                           hf.value(x, by - 1))[layer];
+                    },
+                    [&](size_t begin, size_t end, const SideSegment& s) {
+                        addSide(begin, end, s, back);
+                    });
+            }
+            if (by < hf.dims.y) {  // Front faces of the bars behind the grid line
+                forEachRun(
+                    hf.dims.x,
+                    [&](size_t x) {
+                        return exposedSide(hf.height(x, by), by > 0 ? hf.height(x, by - 1) : 0.0f,
+                                           hf.value(x, by))[layer];
+                    },
+                    [&](size_t begin, size_t end, const SideSegment& s) {
+                        addSide(begin, end, s, front);
+                    });
+            }
+        }
+    }
+}
+
+// A rectangle of pixels [x0, x1) x [y0, y1) that share the same value
+struct TopRect {
+    size_t x0, y0, x1, y1;
+    float value;
+};
+
+// Greedily merge pixels with the same value (and therefore the same height and color)
+std::vector<TopRect> mergeTopFaces(const HeightField& hf) {
+    std::vector<TopRect> rects;
+    std::vector<bool> merged(hf.values.size(), false);
+    for (size_t y = 0; y < hf.dims.y; ++y) {
+        for (size_t x = 0; x < hf.dims.x; ++x) {
+            if (merged[hf.index(x, y)]) continue;
+
+            const float imageValue = hf.value(x, y);
+            auto mergeable = [&](size_t i, size_t j) {
+                return !merged[hf.index(i, j)] && hf.value(i, j) == imageValue;
+            };
+
+            size_t x1 = x + 1;
+            while (x1 < hf.dims.x && mergeable(x1, y)) ++x1;
+            size_t y1 = y + 1;
+            while (y1 < hf.dims.y) {
+                bool rowMergeable = true;
+                for (size_t i = x; i < x1 && rowMergeable; ++i) rowMergeable = mergeable(i, y1);
+                if (!rowMergeable) break;
+                ++y1;
+            }
+            for (size_t j = y; j < y1; ++j) {
+                for (size_t i = x; i < x1; ++i) merged[hf.index(i, j)] = true;
+            }
+            rects.push_back({x, y, x1, y1, imageValue});
+        }
+    }
+    return rects;
+}
+
+/*
+ * Bars with culled hidden faces. The number of faces of every top rectangle and every grid
+ * line is counted first, the faces are then written in parallel directly into the buffers
+ * at their precomputed offsets.
+ */
+ImageToHeightfield::Geometry buildBarGeometry(const HeightField& hf) {
+    constexpr auto down = vec3(0.0f, -1.0f, 0.0f);
+    constexpr auto up = vec3(0.0f, 1.0f, 0.0f);
+
+    const auto rects = mergeTopFaces(hf);
+    const size_t numLines = hf.dims.x + hf.dims.y + 2;
+
+    // Face offsets, a top rectangle has a bottom face as well if it is below zero
+    std::vector<size_t> rectOffsets(rects.size() + 1, 0);
+    for (size_t i = 0; i < rects.size(); ++i) {
+        rectOffsets[i + 1] = rectOffsets[i] + (rects[i].value < 0.0f ? 2 : 1);
+    }
+    std::vector<size_t> lineOffsets(numLines + 1, 0);
+    util::forEachIndexParallel(numLines, [&](size_t line) {
+        size_t count = 0;
+        forEachSideFace(hf, line, [&](auto&&...) { ++count; });
+        lineOffsets[line + 1] = count;
     });
+    lineOffsets[0] = rectOffsets.back();
+    std::partial_sum(lineOffsets.begin(), lineOffsets.end(), lineOffsets.begin());
+    const size_t numFaces = lineOffsets.back();
 
-    mesh->addVertices(vertices);
+    ImageToHeightfield::Geometry geometry;
+    const GeometryWriter writer(geometry, 4 * numFaces, 6 * numFaces);
 
+    const vec2 cellSize = hf.cellSize();
+    auto corner = [&](size_t x, float height, size_t z) {
+        return vec3(x * cellSize.x, height, z * cellSize.y);
+    };
+
+    util::forEachIndexParallel(rects.size(), [&](size_t i) {
+        const auto& r = rects[i];
+        const float height = r.value;
+        writer.addFace(rectOffsets[i], corner(r.x0, height, r.y0), corner(r.x1, height, r.y0),
+                       corner(r.x1, height, r.y1), corner(r.x0, height, r.y1), up,
+                       r.value);  // Top face
+        if (height < 0.0f) {
+            writer.addFace(rectOffsets[i] + 1, corner(r.x0, 0.0f, r.y0),
+                           corner(r.x1, 0.0f, r.y0), corner(r.x1, 0.0f, r.y1),
+                           corner(r.x0, 0.0f, r.y1), down, r.value);  // Bottom face
+        }
+    });
+    util::forEachIndexParallel(numLines, [&](size_t line) {
+        size_t face = lineOffsets[line];
+        forEachSideFace(hf, line,
+                        [&](const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                            const vec3& normal, float value) {
+                            writer.addFace(face++, c1, c2, c3, c4, normal, value);
+                        });
+    });
+
+    return geometry;
+}
+
+/*
+ * One continuous surface with a vertex per pixel center. The vertex and index of every pixel
+ * is known from its position so all rows are written in parallel.
+ */
+ImageToHeightfield::Geometry buildSurfaceGeometry(const HeightField& hf) {
+    const auto dims = hf.dims;
+    const size_t numQuads = dims.x > 1 && dims.y > 1 ? (dims.x - 1) * (dims.y - 1) : 0;
+
+    ImageToHeightfield::Geometry geometry;
+    const GeometryWriter writer(geometry, dims.x * dims.y, 6 * numQuads);
+
+    const vec2 cellSize = hf.cellSize();
+    util::forEachIndexParallel(dims.y, [&](size_t y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const vec2 center2D = (vec2(x, y) + 0.5f) * cellSize;
+            const float imageValue = hf.value(x, y);
+
+            // Normal from central differences, one sided at the image border
+            const size2_t pos(x, y);
+            const size2_t prev = glm::max(pos, size2_t(1)) - size2_t(1);
+            const size2_t next = glm::min(pos + size2_t(1), dims - size2_t(1));
+            const vec2 step = vec2(glm::max(next - prev, size2_t(1))) * cellSize;
+            const float dhdx = (hf.height(next.x, y) - hf.height(prev.x, y)) / step.x;
+            const float dhdz = (hf.height(x, next.y) - hf.height(x, prev.y)) / step.y;
+            const vec3 normal = glm::normalize(vec3(-dhdx, 1.0f, -dhdz));
+
+            writer.setVertex(hf.index(x, y), vec3(center2D.x, imageValue, center2D.y), normal,
+                             imageValue);
+        }
+
+        // Two triangles per quad between four pixel centers, same winding as the bar top faces
+        if (y + 1 >= dims.y) return;
+        std::uint32_t* i = writer.indices + 6 * y * (dims.x - 1);
+        for (size_t x = 0; x + 1 < dims.x; ++x, i += 6) {
+            const auto i00 = static_cast<std::uint32_t>(hf.index(x, y));
+            const auto i10 = static_cast<std::uint32_t>(hf.index(x + 1, y));
+            const auto i01 = static_cast<std::uint32_t>(hf.index(x, y + 1));
+            const auto i11 = static_cast<std::uint32_t>(hf.index(x + 1, y + 1));
+            i[0] = i00;
+            i[1] = i10;
+            i[2] = i11;
+            i[3] = i00;
+            i[4] = i11;
+            i[5] = i01;
+        }
+    });
+
+    return geometry;
+}
+
+// Colors for all vertices, computed in parallel blocks through ScalarToColorMapping::sampleBatch
+std::shared_ptr<Buffer<vec4>> colorize(const std::vector<float>& values,
+                                       const ScalarToColorMapping& map) {
+    auto buffer = std::make_shared<Buffer<vec4>>(values.size());
+    vec4* colors = buffer->getEditableRAMRepresentation()->getDataContainer().data();
+
+    constexpr size_t blockSize = 4096;
+    util::forEachIndexParallel((values.size() + blockSize - 1) / blockSize, [&](size_t block) {
+        const size_t begin = block * blockSize;
+        const size_t count = std::min(blockSize, values.size() - begin);
+        map.sampleBatch(util::span<const float>(values.data() + begin, count),
+                        util::span<vec4>(colors + begin, count));
+    });
+    return buffer;
+}
+
+/*
+ * Surface through every 2^level:th sample of the chunk. The last row and column are moved to
+ * the image border for chunks that extend outside of the image. A skirt hanging down to the
+ * chunk minimum along the chunk border hides cracks towards neighbours with a different level.
+ */
+ImageToHeightfield::Geometry buildChunkGeometry(const HeightfieldChunk& chunk, size_t level,
+                                                size2_t imageDims) {
+    const size_t stride = size_t{1} << level;
+    const size2_t extent = chunk.getExtent();
+    const size2_t n = (extent + size2_t(stride - 1)) / stride + size2_t(1);
+    const size_t numQuads = (n.x - 1) * (n.y - 1);
+    const size_t numBorder = 2 * (n.x - 1) + 2 * (n.y - 1);
+
+    ImageToHeightfield::Geometry geometry;
+    const GeometryWriter writer(geometry, n.x * n.y + 2 * numBorder, 6 * (numQuads + numBorder));
+
+    auto sampleIndex = [&](size_t i, size_t axis) { return std::min(i * stride, extent[axis]); };
+    const vec2 cellSize = 1.0f / vec2(imageDims);
+    for (size_t j = 0; j < n.y; ++j) {
+        for (size_t i = 0; i < n.x; ++i) {
+            const size2_t s(sampleIndex(i, 0), sampleIndex(j, 1));
+            const vec2 center2D = (vec2(chunk.getOrigin() + s) + 0.5f) * cellSize;
+            const float value = chunk.getSample(s.x, s.y);
+
+            // Normal from the full resolution gradient, as for the continuous surface. Vertices on
+            // the chunk border get the same normal in both chunks, so there are no shading seams.
+            const vec2 gradient = chunk.getGradient(s.x, s.y) / cellSize;
+            const vec3 normal = glm::normalize(vec3(-gradient.x, 1.0f, -gradient.y));
+
+            writer.setVertex(i + j * n.x, vec3(center2D.x, value, center2D.y), normal, value);
+        }
+    }
+
+    std::uint32_t* index = writer.indices;
+    auto addTriangle = [&](size_t a, size_t b, size_t c) {
+        *index++ = static_cast<std::uint32_t>(a);
+        *index++ = static_cast<std::uint32_t>(b);
+        *index++ = static_cast<std::uint32_t>(c);
+    };
+    for (size_t j = 0; j + 1 < n.y; ++j) {
+        for (size_t i = 0; i + 1 < n.x; ++i) {
+            const size_t i00 = i + j * n.x;
+            const size_t i10 = i00 + 1;
+            const size_t i01 = i00 + n.x;
+            const size_t i11 = i01 + 1;
+            addTriangle(i00, i10, i11);
+            addTriangle(i00, i11, i01);
+        }
+    }
+
+    // Skirt, every border edge a-b gets a quad down to the chunk minimum
+    size_t skirtVertex = n.x * n.y;
+    auto addSkirt = [&](size_t a, size_t b) {
+        for (size_t v : {a, b}) {
+            const vec3 p = writer.positions[v];
+            writer.setVertex(skirtVertex++, vec3(p.x, chunk.getMin(), p.z), writer.normals[v],
+                             writer.values[v]);
+        }
+        addTriangle(a, b, skirtVertex - 1);
+        addTriangle(a, skirtVertex - 1, skirtVertex - 2);
+    };
+    for (size_t i = 0; i + 1 < n.x; ++i) {
+        addSkirt(i, i + 1);
+        addSkirt(i + (n.y - 1) * n.x, i + 1 + (n.y - 1) * n.x);
+    }
+    for (size_t j = 0; j + 1 < n.y; ++j) {
+        addSkirt(j * n.x, (j + 1) * n.x);
+        addSkirt(n.x - 1 + j * n.x, n.x - 1 + (j + 1) * n.x);
+    }
+
+    return geometry;
+}
+
+// A new mesh sharing the given buffers, only buffers that changed need to be uploaded again
+std::shared_ptr<Mesh> makeMesh(const ImageToHeightfield::Geometry& geometry,
+                               std::shared_ptr<Buffer<vec4>> colorBuffer, float heightScale) {
+    auto mesh = std::make_shared<Mesh>(DrawType::Triangles, ConnectivityType::None);
+    mesh->addBuffer(BufferType::PositionAttrib, geometry.positions);
+    mesh->addBuffer(BufferType::NormalAttrib, geometry.normals);
+    mesh->addBuffer(BufferType::ColorAttrib, colorBuffer);
+    mesh->addIndices(Mesh::MeshInfo(DrawType::Triangles, ConnectivityType::None),
+                     geometry.indices);
+
+    mat4 modelMatrix(1.0f);
+    modelMatrix[1][1] = heightScale;
+    mesh->setModelMatrix(modelMatrix);
     return mesh;
 }
 
+ScalarToColorMapping createColorMapping(size_t numColors,
+                                        const std::array<FloatVec4Property, 10>& colors) {
+    ScalarToColorMapping map;
+    for (size_t i = 0; i < numColors; i++) {
+        map.addBaseColors(colors[i].get());
+    }
+    return map;
+}
+
 }  // namespace
 
 void ImageToHeightfield::process() {
-    const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+    ScopedTimer timer("ImageToHeightfield::process");
+    if (meshMode_ == MeshMode::ChunkedSurface) {
+        processChunks();
+        return;
+    }
 
-    ScalarToColorMapping map;
-    for (size_t i = 0; i < numColors_.get(); i++) {
-        map.addBaseColors(colors_[i].get());
+    if (!geometry_) {
+        ScopedTimer geometryTimer("ImageToHeightfield geometry");
+        const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+        const auto imageValues = readImageValues(*layer);
+        const HeightField hf{layer->getDimensions(), imageValues};
+
+        geometry_ = meshMode_ == MeshMode::Surface ? buildSurfaceGeometry(hf)
+                                                   : buildBarGeometry(hf);
+        colorBuffer_.reset();
     }
 
-    const auto mesh = buildMesh(*layer, map, heightScaleFactor_);
+    if (!colorBuffer_) {
+        ScopedTimer colorTimer("ImageToHeightfield colors");
+        const auto map = createColorMapping(numColors_, colors_);
+        colorBuffer_ = colorize(geometry_->vertexValues, map);
+    }
+
+    meshOutport_.setData(makeMesh(*geometry_, colorBuffer_, heightScaleFactor_));
+    chunksOutport_.clear();
+}
+
+void ImageToHeightfield::processChunks() {
+    const auto dims = imageInport_.getData()->getDimensions();
+
+    if (chunksOutdated_) {
+        const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+        const auto imageValues = readImageValues(*layer);
+
+        const size_t size = chunkSize_;
+        const size2_t numChunks = glm::max((dims - size2_t(1) + size2_t(size - 1)) / size,
+                                           size2_t(1));
+        std::vector<Chunk> chunks(numChunks.x * numChunks.y);
+        util::forEachIndexParallel(chunks.size(), [&](size_t i) {
+            const size2_t origin = size2_t(i % numChunks.x, i / numChunks.x) * size;
+            if (i < chunks_.size() && chunks_[i].data.matches(imageValues, dims, origin, size)) {
+                chunks[i] = std::move(chunks_[i]);
+            } else {
+                chunks[i].data = HeightfieldChunk(imageValues, dims, origin, size);
+            }
+        });
+        chunks_ = std::move(chunks);
+        chunksOutdated_ = false;
+    }
+
+    // The tolerance is relative to the value range of the image, which makes it independent of
+    // the data format and of the height scale
+    float minValue = chunks_.front().data.getMin();
+    float maxValue = chunks_.front().data.getMax();
+    for (const auto& chunk : chunks_) {
+        minValue = std::min(minValue, chunk.data.getMin());
+        maxValue = std::max(maxValue, chunk.data.getMax());
+    }
+    const float tolerance = errorTolerance_ * (maxValue - minValue);
+    std::atomic<size_t> rebuiltChunks{0};
+    ScopedTimer geometryTimer("ImageToHeightfield chunk geometry");
+    util::forEachIndexParallel(chunks_.size(), [&](size_t i) {
+        auto& chunk = chunks_[i];
+        const size_t level = chunk.data.selectLevel(tolerance);
+        if (!chunk.geometry || chunk.level != level) {
+            chunk.level = level;
+            chunk.geometry = buildChunkGeometry(chunk.data, level, dims);
+            chunk.colorBuffer.reset();
+            ++rebuiltChunks;
+        }
+    });
+    geometryTimer.stop();
+    Tracer::get().addCounter("ImageToHeightfield chunks rebuilt",
+                             static_cast<int64_t>(rebuiltChunks.load()));
+
+    const auto map = createColorMapping(numColors_, colors_);
+    auto meshes = std::make_shared<std::vector<std::shared_ptr<Mesh>>>();
+    for (auto& chunk : chunks_) {
+        if (!chunk.colorBuffer) {
+            chunk.colorBuffer = colorize(chunk.geometry->vertexValues, map);
+        }
+        meshes->push_back(makeMesh(*chunk.geometry, chunk.colorBuffer, heightScaleFactor_));
+    }
 
-    meshOutport_.setData(mesh);
+    chunksOutport_.setData(meshes);
+    meshOutport_.clear();
 }
 
 }  // namespace inviwo
@@ -3,16 +3,41 @@
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/meshport.h>
 #include <modules/base/properties/gaussianproperty.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/heightfieldchunk.h>
 #include <inviwo/core/datastructures/geometry/basicmesh.h>
 
+#include <optional>
+
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB1_API ImageToHeightfield : public Processor {
 public:
+    /**
+     * Bars: one box per pixel.
+     * Surface: one continuous indexed surface with a shared vertex per pixel center.
+     * ChunkedSurface: the surface split into square chunks, output as one mesh per chunk on the
+     * chunk outport. The resolution of each chunk is the coarsest level of detail within the
+     * error tolerance.
+     */
+    enum class MeshMode { Bars, Surface, ChunkedSurface };
+
+    /**
+     * Heightfield geometry built with a height scale of one, the height scale is applied through
+     * the model matrix. vertexValues holds the image value of every vertex so that the colors can
+     * be recomputed without touching the geometry.
+     */
+    struct Geometry {
+        std::shared_ptr<Buffer<vec3>> positions;
+        std::shared_ptr<Buffer<vec3>> normals;
+        std::shared_ptr<IndexBuffer> indices;
+        std::vector<float> vertexValues;
+    };
+
     ImageToHeightfield();
     virtual ~ImageToHeightfield() = default;
 
@@ -22,13 +47,36 @@ public:
     static const ProcessorInfo processorInfo_;
 
 private:
+    struct Chunk {
+        HeightfieldChunk data;
+        size_t level = 0;
+        std::optional<Geometry> geometry;  // at level
+        std::shared_ptr<Buffer<vec4>> colorBuffer;
+    };
+
+    void processChunks();
+
     ImageInport imageInport_;
     MeshOutport meshOutport_;
+    DataOutport<std::vector<std::shared_ptr<Mesh>>> chunksOutport_;
+    TemplateOptionProperty<MeshMode> meshMode_;
     FloatProperty heightScaleFactor_;
+    TemplateOptionProperty<size_t> chunkSize_;
+    // Maximal vertical error of a chunk as a fraction of the value range of the image
+    FloatProperty errorTolerance_;
 
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
 
+    // Cached for the current input, reset when the image or the mesh mode changes
+    std::optional<Geometry> geometry_;
+    // Reset when any of the colors change
+    std::shared_ptr<Buffer<vec4>> colorBuffer_;
+
+    // Chunks of the last input in row-major order. Chunks whose image values did not change are
+    // kept when the input changes.
+    std::vector<Chunk> chunks_;
+    bool chunksOutdated_ = true;
 };
 
 }  // namespace inviwo
@@ -1,129 +1,427 @@
 #include <inviwo/core/util/logcentral.h>
 #include <modules/opengl/texture/textureutils.h>
 #include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <modules/tnm067lab1/utils/axissampling.h>
 #include <modules/tnm067lab1/utils/interpolationmethods.h>
+#include <modules/tnm067lab1/utils/mappedfile.h>
+#include <modules/tnm067lab1/utils/parallel.h>
+#include <modules/tnm067lab1/utils/tracer.h>
 #include <inviwo/core/datastructures/image/layerram.h>
 #include <inviwo/core/datastructures/image/layerramprecision.h>
-#include <inviwo/core/util/imageramutils.h>
+#include <inviwo/core/util/exception.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace inviwo {
 
 namespace detail {
 
+using Method = ImageUpsampler::IntepolationMethod;
+
+/*
+ * Type the interpolation is done in: double, or a double vector with the extent of the pixel
+ * type. The interpolation functions multiply the values with double weights, which glm only
+ * supports for vectors of the same precision, and Float16 pixels have no arithmetic of their own.
+ * The weights of a pixel are computed once and applied to all channels in one vector operation.
+ */
 template <typename T>
-void upsample(ImageUpsampler::IntepolationMethod method, const LayerRAMPrecision<T>& inputImage,
-              LayerRAMPrecision<T>& outputImage) {
-    using F = typename float_type<T>::type;
+using WorkType = util::same_extent_t<T, double>;
 
-    const size2_t inputSize = inputImage.getDimensions();
-    const size2_t outputSize = outputImage.getDimensions();
+// Convert an interpolated value back to the pixel type. Integer channels, of scalars and vectors
+// alike, are clamped to their range since quadratic interpolation can overshoot.
+template <typename T>
+T toPixel(const WorkType<T>& value) {
+    using C = typename util::value_type<T>::type;
+    if constexpr (std::is_integral_v<C>) {
+        return static_cast<T>(glm::clamp(value, WorkType<T>(std::numeric_limits<C>::lowest()),
+                                         WorkType<T>(std::numeric_limits<C>::max())));
+    } else {
+        return static_cast<T>(value);
+    }
+}
 
-    const T* inPixels = inputImage.getDataTyped();
-    T* outPixels = outputImage.getDataTyped();
+// The input samples each output sample is interpolated from, along each axis
+template <Method M>
+constexpr AxisSampling::Footprint footprint() {
+    if constexpr (M == Method::PiecewiseConstant) {
+        return AxisSampling::Footprint::Nearest;
+    } else if constexpr (M == Method::Quadratic) {
+        return AxisSampling::Footprint::Quadratic;
+    } else {
+        return AxisSampling::Footprint::Linear;
+    }
+}
 
-    auto inIndex = [&inputSize](auto pos) -> size_t {
-        pos = glm::clamp(pos, decltype(pos)(0), decltype(pos)(inputSize - size2_t(1)));
-        return pos.x + pos.y * inputSize.x;
-    };
-    auto outIndex = [&outputSize](auto pos) -> size_t {
-        pos = glm::clamp(pos, decltype(pos)(0), decltype(pos)(outputSize - size2_t(1)));
-        return pos.x + pos.y * outputSize.x;
+/*
+ * Fixed stencils for an integer upsampling factor k along one axis. Output k * i + j then reads
+ * input i + offset[j] onwards. Valid for the input pixels in [begin, end), where no clamping
+ * occurs. factor is zero if the ratio is not an integer. The fractions are still read from the
+ * sampling table per output column, factors like 3 do not give exactly periodic floating point
+ * fractions, so the block kernels give bit-identical results to the generic ones.
+ */
+struct AxisStencil {
+    size_t factor = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<int> offset;
+};
+
+/*
+ * Derives the stencils from the sampling table at input pixel 1 and only uses them if they
+ * reproduce the input indices of the table for all interior input pixels.
+ */
+AxisStencil axisStencil(const AxisSampling& s, size_t inputSize) {
+    const size_t outputSize = s.t.size();
+    if (inputSize < 4 || outputSize % inputSize != 0) return {};
+
+    AxisStencil stencil;
+    const size_t k = outputSize / inputSize;
+    stencil.offset.resize(k);
+    for (size_t j = 0; j < k; ++j) {
+        stencil.offset[j] = static_cast<int>(s.i0[k + j]) - 1;
+        // The block kernels load the input pixels i - 1 to i + 2
+        if (stencil.offset[j] < -1 || stencil.offset[j] > 0) return {};
+    }
+    for (size_t i = 1; i + 2 < inputSize; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            const size_t o = i * k + j;
+            if (s.i0[o] + 1 != s.i0[k + j] + i || s.i1[o] + 1 != s.i1[k + j] + i ||
+                s.i2[o] + 1 != s.i2[k + j] + i) {
+                return {};
+            }
+        }
+    }
+    stencil.factor = k;
+    stencil.begin = 1;
+    stencil.end = inputSize - 2;
+    return stencil;
+}
+
+/*
+ * Splits the output columns [begin, end) into whole blocks of k columns covered by the stencil,
+ * passed as the input pixel to block(i), and the remaining ranges passed to generic(x0, x1).
+ */
+template <typename G, typename B>
+void forEachColumnRange(const AxisStencil& stencil, size_t begin, size_t end, G generic,
+                        B block) {
+    const size_t k = stencil.factor;
+    const size_t first = k == 0 ? 0 : std::max((begin + k - 1) / k, stencil.begin);
+    const size_t last = k == 0 ? 0 : std::min(end / k, stencil.end);
+    if (first >= last) {
+        generic(begin, end);
+        return;
+    }
+    generic(begin, first * k);
+    for (size_t i = first; i < last; ++i) block(i);
+    generic(last * k, end);
+}
+
+// Interpolation along one axis for the separable methods
+template <Method M, typename W>
+W interpolate(const W& a, const W& b, const W& c, double t) {
+    if constexpr (M == Method::Bilinear) {
+        return TNM067::Interpolation::linear(a, b, t);
+    } else {
+        return TNM067::Interpolation::quadratic(a, b, c, t);
+    }
+}
+
+/*
+ * Calls callback(begin, end) for every tile of the output rows [yBegin, yEnd), the tiles are
+ * processed in parallel. The tile size keeps the output tile and the input rows it reads within
+ * the L2 cache for common formats. The tile width is a multiple of the stencil factor, so that
+ * the same columns take the block path independent of the tiling.
+ */
+template <typename C>
+void forEachTile(const AxisStencil& stencil, size_t width, size_t yBegin, size_t yEnd,
+                 C callback) {
+    const size_t k = std::max(stencil.factor, size_t{1});
+    const size2_t tileSize(std::max(256 / k, size_t{1}) * k, 32);
+    const size2_t numTiles((width + tileSize.x - 1) / tileSize.x,
+                           (yEnd - yBegin + tileSize.y - 1) / tileSize.y);
+    util::forEachIndexParallel(numTiles.x * numTiles.y, [&](size_t i) {
+        const size2_t tile(i % numTiles.x, i / numTiles.x);
+        const size2_t begin(tile.x * tileSize.x, yBegin + tile.y * tileSize.y);
+        callback(begin, glm::min(begin + tileSize, size2_t(width, yEnd)));
+    });
+}
+
+// Sampling tables of both axes for an input and output size
+template <Method M>
+struct Sampling {
+    Sampling(size2_t inputSize, size2_t outputSize)
+        : xs(footprint<M>(), inputSize.x, outputSize.x)
+        , ys(footprint<M>(), inputSize.y, outputSize.y)
+        , xStencil(axisStencil(xs, inputSize.x)) {}
+
+    AxisSampling xs;
+    AxisSampling ys;
+    AxisStencil xStencil;
+};
+
+/*
+ * Upsample the output rows [yBegin, yEnd) with the interpolation method as a template parameter.
+ * inRow(y) and outRow(y) return pointers to input row y and output row y respectively, only the
+ * input rows read by the given output rows are accessed. The output is processed in
+ * tiles in parallel. Bilinear and quadratic interpolation are separable: the input rows under a
+ * tile are first interpolated horizontally for the tile's output columns, the output rows are
+ * then interpolated vertically from those. Each input row is thereby read once per tile and the
+ * inner loops only consist of table lookups and the interpolation itself.
+ *
+ * For integer ratios the horizontal weights repeat for every input pixel. The interior columns
+ * then load the neighbourhood of an input pixel once and emit its k outputs from fixed stencils.
+ * Output rows that share their source rows and weights are copied instead of recomputed.
+ */
+template <Method M, typename T, typename InRow, typename OutRow>
+void upsampleRows(const Sampling<M>& sampling, InRow inRow, OutRow outRow, size_t yBegin,
+                  size_t yEnd) {
+    using W = WorkType<T>;
+
+    const auto& xs = sampling.xs;
+    const auto& ys = sampling.ys;
+    const auto& xStencil = sampling.xStencil;
+    const size_t k = xStencil.factor;
+    const size_t width = xs.t.size();
+
+    // Output row y is identical to row y - 1 if both read the same input rows with the same weights
+    auto sameAsPreviousRow = [&](size_t y) {
+        return ys.i0[y] == ys.i0[y - 1] && ys.i1[y] == ys.i1[y - 1] &&
+               ys.i2[y] == ys.i2[y - 1] && ys.t[y] == ys.t[y - 1];
     };
 
-    util::forEachPixel(outputImage, [&](ivec2 outImageCoords) {
-        // outImageCoords: Exact pixel coordinates in the output image currently writing to
-        // inImageCoords: Relative coordinates of outImageCoords in the input image, might be
-        // between pixels
-        dvec2 inImageCoords =
-            ImageUpsampler::convertCoordinate(outImageCoords, inputSize, outputSize);
-
-        T finalColor(0);
-
-        // DUMMY COLOR, remove or overwrite this bellow
-        finalColor = inPixels[inIndex(
-            glm::clamp(size2_t(outImageCoords), size2_t(0), size2_t(inputSize - size2_t(1))))];
-
-        switch (method) {
-            case ImageUpsampler::IntepolationMethod::PiecewiseConstant: {
-                // Task 8
-                // Update finalColor
-                finalColor = inPixels[inIndex(floor(inImageCoords))];
-                break;
+    if constexpr (M == Method::PiecewiseConstant) {
+        // Task 8
+        forEachTile(xStencil, width, yBegin, yEnd, [&](size2_t begin, size2_t end) {
+            for (size_t y = begin.y; y < end.y; ++y) {
+                T* out = outRow(y);
+                if (y > begin.y && sameAsPreviousRow(y)) {
+                    std::copy(outRow(y - 1) + begin.x, outRow(y - 1) + end.x, out + begin.x);
+                    continue;
+                }
+                const T* row = inRow(ys.i0[y]);
+                forEachColumnRange(
+                    xStencil, begin.x, end.x,
+                    [&](size_t x0, size_t x1) {
+                        for (size_t x = x0; x < x1; ++x) out[x] = row[xs.i0[x]];
+                    },
+                    [&](size_t i) { std::fill(out + i * k, out + (i + 1) * k, row[i]); });
             }
-            case ImageUpsampler::IntepolationMethod::Bilinear: {
-                // inImageCoords
-                dvec2 black_dot = inImageCoords - 0.5;
-                ivec2 black_dot_floored = ivec2(black_dot);
-
-                // Get neighbour pixels
-                std::array<T, 4> values = { 
-                    inPixels[inIndex(black_dot_floored)],
-                    inPixels[inIndex(black_dot_floored + ivec2(1, 0))],
-                    inPixels[inIndex(black_dot_floored + ivec2(0, 1))],
-                    inPixels[inIndex(black_dot_floored + ivec2(1, 1))]
-                };
-
-                // Update finalColor
-                finalColor = TNM067::Interpolation::bilinear(values, black_dot.x - (int)black_dot.x, black_dot.y - (int)black_dot.y);
-
-                break;
+        });
+    } else if constexpr (M == Method::Barycentric) {
+        // The triangle depends on both coordinates, so it is not separable
+        forEachTile(xStencil, width, yBegin, yEnd, [&](size2_t begin, size2_t end) {
+            for (size_t y = begin.y; y < end.y; ++y) {
+                T* out = outRow(y);
+                if (y > begin.y && sameAsPreviousRow(y)) {
+                    std::copy(outRow(y - 1) + begin.x, outRow(y - 1) + end.x, out + begin.x);
+                    continue;
+                }
+                const T* row0 = inRow(ys.i0[y]);
+                const T* row1 = inRow(ys.i1[y]);
+                const double ty = ys.t[y];
+                forEachColumnRange(
+                    xStencil, begin.x, end.x,
+                    [&](size_t x0, size_t x1) {
+                        for (size_t x = x0; x < x1; ++x) {
+                            const std::array<W, 4> values = {
+                                W(row0[xs.i0[x]]), W(row0[xs.i1[x]]), W(row1[xs.i0[x]]),
+                                W(row1[xs.i1[x]])};
+                            out[x] = toPixel<T>(
+                                TNM067::Interpolation::barycentric(values, xs.t[x], ty));
+                        }
+                    },
+                    [&](size_t i) {
+                        const std::array<W, 3> v0 = {W(row0[i - 1]), W(row0[i]), W(row0[i + 1])};
+                        const std::array<W, 3> v1 = {W(row1[i - 1]), W(row1[i]), W(row1[i + 1])};
+                        for (size_t j = 0; j < k; ++j) {
+                            const size_t a = 1 + xStencil.offset[j];
+                            const std::array<W, 4> values = {v0[a], v0[a + 1], v1[a], v1[a + 1]};
+                            out[i * k + j] = toPixel<T>(
+                                TNM067::Interpolation::barycentric(values, xs.t[i * k + j], ty));
+                        }
+                    });
             }
-            case ImageUpsampler::IntepolationMethod::Quadratic: {
-                // Update finalColor
-
-                // inImageCoords
-                dvec2 black_dot = inImageCoords - 0.5;
-                ivec2 black_dot_floored = ivec2(black_dot);
-
-                // Get neighbour pixels
-                std::array<T, 9> values = { 
-                    inPixels[inIndex(black_dot_floored)],
-                    inPixels[inIndex(black_dot_floored + ivec2(1, 0))],
-                    inPixels[inIndex(black_dot_floored + ivec2(2, 0))],
-                    inPixels[inIndex(black_dot_floored + ivec2(0, 1))],
-                    inPixels[inIndex(black_dot_floored + ivec2(1, 1))],
-                    inPixels[inIndex(black_dot_floored + ivec2(2, 1))],
-                    inPixels[inIndex(black_dot_floored + ivec2(0, 2))],
-                    inPixels[inIndex(black_dot_floored + ivec2(1, 2))],
-                    inPixels[inIndex(black_dot_floored + ivec2(2, 2))]
-                };
-
-                // Update finalColor
-                double dx = black_dot.x - (int)black_dot.x;
-                double dy = black_dot.y - (int)black_dot.y;
-
-                finalColor = TNM067::Interpolation::biQuadratic(values, dx / 2.0, dy / 2.0);
-
-                break;
+        });
+    } else {
+        forEachTile(xStencil, width, yBegin, yEnd, [&](size2_t begin, size2_t end) {
+            // The source indices are non-decreasing, so the tile reads a contiguous range of
+            // input rows
+            const size_t firstRow = ys.i0[begin.y];
+            const size_t lastRow = M == Method::Bilinear ? ys.i1[end.y - 1] : ys.i2[end.y - 1];
+            const size_t tileWidth = end.x - begin.x;
+
+            // Horizontally interpolated input rows, restricted to the tile's columns
+            std::vector<W> horizontal((lastRow - firstRow + 1) * tileWidth);
+            for (size_t r = firstRow; r <= lastRow; ++r) {
+                const T* row = inRow(r);
+                W* h = horizontal.data() + (r - firstRow) * tileWidth;
+                forEachColumnRange(
+                    xStencil, begin.x, end.x,
+                    [&](size_t x0, size_t x1) {
+                        for (size_t x = x0; x < x1; ++x) {
+                            h[x - begin.x] = interpolate<M>(W(row[xs.i0[x]]), W(row[xs.i1[x]]),
+                                                            W(row[xs.i2[x]]), xs.t[x]);
+                        }
+                    },
+                    [&](size_t i) {
+                        const std::array<W, 4> v = {W(row[i - 1]), W(row[i]), W(row[i + 1]),
+                                                    W(row[i + 2])};
+                        for (size_t j = 0; j < k; ++j) {
+                            const size_t a = 1 + xStencil.offset[j];
+                            h[i * k + j - begin.x] =
+                                interpolate<M>(v[a], v[a + 1], v[a + 2], xs.t[i * k + j]);
+                        }
+                    });
             }
-            case ImageUpsampler::IntepolationMethod::Barycentric: {
-                // inImageCoords
-                dvec2 p = inImageCoords - 0.5;
-                ivec2 p_floored = ivec2(p);
-
-                // Get neighbour pixels
-                std::array<T, 4> values = {inPixels[inIndex(p_floored)],
-                                           inPixels[inIndex(p_floored + ivec2(1, 0))],
-                                           inPixels[inIndex(p_floored + ivec2(0, 1))],
-                                           inPixels[inIndex(p_floored + ivec2(1, 1))]};
-                
-                // Update finalColor
-                finalColor = inviwo::TNM067::Interpolation::barycentric(values, p.x - (int)p.x,
-                                                                        p.y - (int)p.y);
-
-
-                break;
+            auto hRow = [&](size_t r) { return horizontal.data() + (r - firstRow) * tileWidth; };
+
+            for (size_t y = begin.y; y < end.y; ++y) {
+                T* out = outRow(y) + begin.x;
+                if (y > begin.y && sameAsPreviousRow(y)) {
+                    std::copy(outRow(y - 1) + begin.x, outRow(y - 1) + end.x, out);
+                    continue;
+                }
+                const double ty = ys.t[y];
+                const W* h0 = hRow(ys.i0[y]);
+                const W* h1 = hRow(ys.i1[y]);
+                // Bilinear interpolation does not read a third row, which may be outside the tile
+                const W* h2 = M == Method::Bilinear ? h1 : hRow(ys.i2[y]);
+                for (size_t i = 0; i < tileWidth; ++i) {
+                    out[i] = toPixel<T>(interpolate<M>(h0[i], h1[i], h2[i], ty));
+                }
             }
-            default:
-                break;
-        }
+        });
+    }
+}
+
+// Calls callback with the method as a std::integral_constant
+template <typename C>
+void dispatchMethod(Method method, C callback) {
+    switch (method) {
+        case Method::PiecewiseConstant:
+            callback(std::integral_constant<Method, Method::PiecewiseConstant>{});
+            break;
+        case Method::Bilinear:
+            callback(std::integral_constant<Method, Method::Bilinear>{});
+            break;
+        case Method::Quadratic:
+            callback(std::integral_constant<Method, Method::Quadratic>{});
+            break;
+        case Method::Barycentric:
+            callback(std::integral_constant<Method, Method::Barycentric>{});
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename T>
+void upsample(ImageUpsampler::IntepolationMethod method, const LayerRAMPrecision<T>& inputImage,
+              LayerRAMPrecision<T>& outputImage) {
+    const size2_t inputSize = inputImage.getDimensions();
+    const size2_t outputSize = outputImage.getDimensions();
 
-        outPixels[outIndex(outImageCoords)] = finalColor;
+    const T* inPixels = inputImage.getDataTyped();
+    T* outPixels = outputImage.getDataTyped();
+
+    dispatchMethod(method, [&](auto m) {
+        const Sampling<decltype(m)::value> sampling(inputSize, outputSize);
+        upsampleRows<decltype(m)::value, T>(
+            sampling, [&](size_t y) { return inPixels + y * inputSize.x; },
+            [&](size_t y) { return outPixels + y * outputSize.x; }, 0, outputSize.y);
     });
 }
 
+/*
+ * Upsamples a raw file of inputSize pixels of type T, stored row by row without header, into a
+ * raw file of outputSize pixels. The output is produced in bands of rows. For each band only the
+ * input rows it reads, including the halo rows of the interpolation, and the band of the output
+ * file are mapped, so the memory use is bounded by the band size and not by the image size.
+ * progress(fraction) is called after every band, returning false stops the upsampling.
+ */
+template <typename T, typename Progress>
+void upsampleFile(ImageUpsampler::IntepolationMethod method, const std::string& inputPath,
+                  size2_t inputSize, const std::string& outputPath, size2_t outputSize,
+                  size_t memoryBudget, Progress progress) {
+    // Opening the output truncates it, which would destroy the input if they are the same file
+    std::error_code error;
+    if (std::filesystem::equivalent(inputPath, outputPath, error)) {
+        throw Exception("The output file " + outputPath + " is the input file",
+                        IVW_CONTEXT_CUSTOM("ImageUpsampler"));
+    }
+
+    const MappedFile input(inputPath, MappedFile::Mode::Read);
+    const size_t inRowBytes = inputSize.x * sizeof(T);
+    const size_t outRowBytes = outputSize.x * sizeof(T);
+    if (input.size() != inputSize.y * inRowBytes) {
+        throw Exception("Size of " + inputPath + " does not match the input dimensions",
+                        IVW_CONTEXT_CUSTOM("ImageUpsampler"));
+    }
+    const MappedFile output(outputPath, MappedFile::Mode::Write, outputSize.y * outRowBytes);
+
+    // Output rows per band such that the band and the input rows it reads fit the budget, the
+    // input footprint of a band is at most three rows larger than its share of the input
+    const double bytesPerRow =
+        outRowBytes + inRowBytes * static_cast<double>(inputSize.y) / outputSize.y;
+    const size_t bandRows = std::max(
+        size_t{1}, static_cast<size_t>((memoryBudget - std::min(memoryBudget, 3 * inRowBytes)) /
+                                       bytesPerRow));
+
+    dispatchMethod(method, [&](auto m) {
+        constexpr Method M = decltype(m)::value;
+        const Sampling<M> sampling(inputSize, outputSize);
+        for (size_t yBegin = 0; yBegin < outputSize.y; yBegin += bandRows) {
+            const size_t yEnd = std::min(yBegin + bandRows, outputSize.y);
+            const size_t firstRow = sampling.ys.i0[yBegin];
+            const size_t lastRow = M == Method::Quadratic ? sampling.ys.i2[yEnd - 1]
+                                                          : sampling.ys.i1[yEnd - 1];
+
+            const auto in = input.map(firstRow * inRowBytes, (lastRow - firstRow + 1) * inRowBytes);
+            const auto out = output.map(yBegin * outRowBytes, (yEnd - yBegin) * outRowBytes);
+            const T* inPixels = static_cast<const T*>(in.data());
+            T* outPixels = static_cast<T*>(out.data());
+
+            upsampleRows<M, T>(
+                sampling, [&](size_t y) { return inPixels + (y - firstRow) * inputSize.x; },
+                [&](size_t y) { return outPixels + (y - yBegin) * outputSize.x; }, yBegin, yEnd);
+
+            if (!progress(static_cast<float>(yEnd) / outputSize.y)) return;
+        }
+    });
+}
+
+// Calls callback with a value of the pixel type of the raw file formats supported by
+// upsampleFile
+template <typename C>
+void dispatchFileFormat(DataFormatId format, C callback) {
+    switch (format) {
+        case DataFormatId::UInt8:
+            callback(glm::u8{});
+            break;
+        case DataFormatId::UInt16:
+            callback(glm::u16{});
+            break;
+        case DataFormatId::Float32:
+            callback(float{});
+            break;
+        case DataFormatId::Vec4UInt8:
+            callback(glm::u8vec4{});
+            break;
+        case DataFormatId::Vec4Float32:
+            callback(vec4{});
+            break;
+        default:
+            throw Exception("Unsupported file format", IVW_CONTEXT_CUSTOM("ImageUpsampler"));
+    }
+}
+
 }  // namespace detail
 
 const ProcessorInfo ImageUpsampler::processorInfo_{
@@ -146,18 +444,51 @@ ImageUpsampler::ImageUpsampler()
                                {"bilinear", "Bilinear", IntepolationMethod::Bilinear},
                                {"quadratic", "Quadratic", IntepolationMethod::Quadratic},
                                {"barycentric", "Barycentric", IntepolationMethod::Barycentric},
-                           }) {
+                           })
+    , file_("file", "File Upsampling")
+    , inputFile_("inputFile", "Input Raw File", "", "default", InvalidationLevel::Valid)
+    , inputDimensions_("inputDimensions", "Input Dimensions", size2_t(256), size2_t(1),
+                       size2_t(1 << 20), size2_t(1), InvalidationLevel::Valid)
+    , fileFormat_("fileFormat", "Format",
+                  {{"uint8", "UInt8", DataFormatId::UInt8},
+                   {"uint16", "UInt16", DataFormatId::UInt16},
+                   {"float32", "Float32", DataFormatId::Float32},
+                   {"vec4uint8", "Vec4UInt8", DataFormatId::Vec4UInt8},
+                   {"vec4float32", "Vec4Float32", DataFormatId::Vec4Float32}},
+                  0, InvalidationLevel::Valid)
+    , outputFile_("outputFile", "Output Raw File", "", "default", InvalidationLevel::Valid)
+    , outputDimensions_("outputDimensions", "Output Dimensions", size2_t(1024), size2_t(1),
+                        size2_t(1 << 20), size2_t(1), InvalidationLevel::Valid)
+    , memoryBudget_("memoryBudget", "Memory Budget (MB)", 256, 1, 16384, 1,
+                    InvalidationLevel::Valid)
+    , upsampleFile_("upsampleFile", "Upsample File", InvalidationLevel::Valid) {
     addPort(inport_);
     addPort(outport_);
     addProperty(interpolationMethod_);
+
+    outputFile_.setAcceptMode(AcceptMode::Save);
+    file_.addProperty(inputFile_);
+    file_.addProperty(inputDimensions_);
+    file_.addProperty(fileFormat_);
+    file_.addProperty(outputFile_);
+    file_.addProperty(outputDimensions_);
+    file_.addProperty(memoryBudget_);
+    file_.addProperty(upsampleFile_);
+    file_.setCollapsed(true);
+    addProperty(file_);
+
+    upsampleFile_.onChange([this]() { upsampleFile(); });
+}
+
+ImageUpsampler::~ImageUpsampler() {
+    // The file job checks for cancellation after every band of rows
+    cancelFileJob_ = true;
+    if (fileJob_.valid()) fileJob_.wait();
 }
 
 void ImageUpsampler::process() {
+    ScopedTimer timer("ImageUpsampler::process");
     auto inputImage = inport_.getData();
-    if (inputImage->getDataFormat()->getComponents() != 1) {
-        LogError("The ImageUpsampler processor does only support single channel images");
-    }
-
     auto inSize = inport_.getData()->getDimensions();
     auto outDim = outport_.getDimensions();
 
@@ -165,14 +496,64 @@ void ImageUpsampler::process() {
     outputImage->getColorLayer()->setSwizzleMask(inputImage->getColorLayer()->getSwizzleMask());
     outputImage->getColorLayer()
         ->getEditableRepresentation<LayerRAM>()
-        ->dispatch<void, dispatching::filter::Scalars>([&](auto outRep) {
+        ->dispatch<void>([&](auto outRep) {
             auto inRep = inputImage->getColorLayer()->getRepresentation<LayerRAM>();
             detail::upsample(interpolationMethod_.get(), *(const decltype(outRep))(inRep), *outRep);
         });
 
+    Tracer::get().addCounter("ImageUpsampler pixels upsampled",
+                             static_cast<int64_t>(outDim.x * outDim.y));
     outport_.setData(outputImage);
 }
 
+void ImageUpsampler::upsampleFile() {
+    if (fileJob_.valid() &&
+        fileJob_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        LogWarn("A file is already being upsampled");
+        return;
+    }
+
+    // The job runs on another thread, so all properties are read here
+    const auto method = interpolationMethod_.get();
+    const auto format = fileFormat_.get();
+    const std::string inputPath = inputFile_.get();
+    const size2_t inputDims = inputDimensions_.get();
+    const std::string outputPath = outputFile_.get();
+    const size2_t outputDims = outputDimensions_.get();
+    const size_t memoryBudget = memoryBudget_.get() * 1024 * 1024;
+
+    // Progress and errors are reported on the main thread, and only while the processor exists
+    auto onMainThread = [alive = std::weak_ptr<bool>(alive_)](auto callback) {
+        dispatchFront([alive, callback]() {
+            if (alive.lock()) callback();
+        });
+    };
+
+    updateProgress(0.0f);
+    // A thread of its own rather than a pool task. The upsampling runs its tiles on the pool, and
+    // a pool task waiting for other pool tasks deadlocks a pool with a single thread.
+    fileJob_ = std::async(std::launch::async, [this, method, format, inputPath, inputDims,
+                                               outputPath, outputDims, memoryBudget,
+                                               onMainThread]() {
+        ScopedTimer timer("ImageUpsampler::upsampleFile");
+        try {
+            detail::dispatchFileFormat(format, [&](auto type) {
+                detail::upsampleFile<decltype(type)>(
+                    method, inputPath, inputDims, outputPath, outputDims, memoryBudget,
+                    [&](float progress) {
+                        onMainThread([this, progress]() { updateProgress(progress); });
+                        return !cancelFileJob_;
+                    });
+            });
+        } catch (const Exception& e) {
+            onMainThread([this, message = e.getMessage()]() {
+                updateProgress(0.0f);
+                LogError(message);
+            });
+        }
+    });
+}
+
 dvec2 ImageUpsampler::convertCoordinate(ivec2 outImageCoords, [[maybe_unused]] size2_t inputSize,
                                         [[maybe_unused]] size2_t outputsize) {
     // TODO implement
@@ -2,19 +2,28 @@
 
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/progressbarowner.h>
 #include <inviwo/core/properties/ordinalproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
 #include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/compositeproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
+#include <inviwo/core/util/formats.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
 
 namespace inviwo {
 
-class IVW_MODULE_TNM067LAB1_API ImageUpsampler : public Processor {
+class IVW_MODULE_TNM067LAB1_API ImageUpsampler : public Processor, public ProgressBarOwner {
 public:
     enum class IntepolationMethod { PiecewiseConstant, Bilinear, Quadratic, Barycentric };
 
     ImageUpsampler();
-    virtual ~ImageUpsampler() = default;
+    virtual ~ImageUpsampler();
 
     virtual void process() override;
 
@@ -24,11 +33,32 @@ public:
     static dvec2 convertCoordinate(ivec2 inputCoordinates, size2_t inputSize, size2_t outputsize);
 
 private:
+    /**
+     * Starts upsampling the raw file given by the file properties in the background, the progress
+     * is shown on the processor. Only parts of the input and output files are mapped into memory
+     * at a time, for images that do not fit into memory.
+     */
+    void upsampleFile();
+
     ImageInport inport_;
     ImageOutport outport_;
 
     // Interpolation method
     TemplateOptionProperty<IntepolationMethod> interpolationMethod_;
+
+    CompositeProperty file_;
+    FileProperty inputFile_;
+    IntSize2Property inputDimensions_;
+    TemplateOptionProperty<DataFormatId> fileFormat_;
+    FileProperty outputFile_;
+    IntSize2Property outputDimensions_;
+    IntSizeTProperty memoryBudget_;  // in MB
+    ButtonProperty upsampleFile_;
+
+    std::future<void> fileJob_;
+    std::atomic<bool> cancelFileJob_{false};
+    // Expires with the processor, callbacks of the file job are only run while it is alive
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
 };
 
 }  // namespace inviwo
@@ -0,0 +1,53 @@
+#include <modules/tnm067lab1/processors/tracerecorder.h>
+#include <modules/tnm067lab1/utils/tracer.h>
+#include <inviwo/core/util/exception.h>
+
+namespace inviwo {
+
+const ProcessorInfo TraceRecorder::processorInfo_{
+    "org.inviwo.TraceRecorder",  // Class identifier
+    "Trace Recorder",            // Display name
+    "TNM067",                    // Category
+    CodeState::Experimental,     // Code state
+    Tags::CPU,                   // Tags
+};
+const ProcessorInfo TraceRecorder::getProcessorInfo() const { return processorInfo_; }
+
+TraceRecorder::TraceRecorder()
+    : Processor()
+    , enabled_("enabled", "Enable Tracing", Tracer::get().isEnabled(), InvalidationLevel::Valid)
+    , maxEvents_("maxEvents", "Max Events", Tracer::get().getMaxEvents(), 1000, 100'000'000, 1000,
+                 InvalidationLevel::Valid)
+    , file_("file", "Trace File", "", "default", InvalidationLevel::Valid)
+    , export_("export", "Export Trace", InvalidationLevel::Valid)
+    , clear_("clear", "Clear Trace", InvalidationLevel::Valid) {
+    file_.setAcceptMode(AcceptMode::Save);
+    addProperty(enabled_);
+    addProperty(maxEvents_);
+    addProperty(file_);
+    addProperty(export_);
+    addProperty(clear_);
+
+    enabled_.onChange([this]() { Tracer::get().setEnabled(enabled_.get()); });
+    maxEvents_.onChange([this]() { Tracer::get().setMaxEvents(maxEvents_.get()); });
+    export_.onChange([this]() { exportTrace(); });
+    clear_.onChange([]() { Tracer::get().clear(); });
+}
+
+void TraceRecorder::process() {}
+
+void TraceRecorder::exportTrace() {
+    if (file_.get().empty()) {
+        LogError("No trace file selected");
+        return;
+    }
+    try {
+        auto& tracer = Tracer::get();
+        tracer.writeChromeTrace(file_.get());
+        LogInfo("Wrote " << tracer.getNumEvents() << " events to " << file_.get());
+    } catch (const Exception& e) {
+        LogError(e.getMessage());
+    }
+}
+
+}  // namespace inviwo
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+
+namespace inviwo {
+
+/**
+ * \class TraceRecorder
+ * \brief Controls the Tracer of the TNM067 modules from the network
+ *
+ * Switches tracing on and off, limits the number of recorded events, and exports the recorded
+ * events as a Chrome trace. The processor has no ports, the Tracer is shared by all processors.
+ */
+class IVW_MODULE_TNM067LAB1_API TraceRecorder : public Processor {
+public:
+    TraceRecorder();
+    virtual ~TraceRecorder() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    void exportTrace();
+
+    BoolProperty enabled_;
+    IntSizeTProperty maxEvents_;
+    FileProperty file_;
+    ButtonProperty export_;
+    ButtonProperty clear_;
+};
+
+}  // namespace inviwo
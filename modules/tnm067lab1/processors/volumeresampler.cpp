@@ -0,0 +1,196 @@
+#include <modules/tnm067lab1/processors/volumeresampler.h>
+#include <modules/tnm067lab1/utils/axissampling.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+#include <modules/tnm067lab1/utils/parallel.h>
+#include <modules/tnm067lab1/utils/tracer.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeram.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/indexmapper.h>
+
+#include <array>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+using Method = VolumeResampler::InterpolationMethod;
+
+// The input voxels each output voxel is interpolated from, along each axis
+AxisSampling::Footprint footprint(Method method) {
+    switch (method) {
+        case Method::PiecewiseConstant:
+            return AxisSampling::Footprint::Nearest;
+        case Method::Triquadratic:
+            return AxisSampling::Footprint::Quadratic;
+        default:
+            return AxisSampling::Footprint::Linear;
+    }
+}
+
+// Converts an interpolated value to the voxel type, clamping integers to their range
+template <typename T>
+T toVoxel(double value) {
+    if constexpr (std::is_integral_v<T>) {
+        using limits = std::numeric_limits<T>;
+        return static_cast<T>(glm::clamp(value, static_cast<double>(limits::lowest()),
+                                         static_cast<double>(limits::max())));
+    } else {
+        return static_cast<T>(value);
+    }
+}
+
+template <Method M, typename T>
+double interpolate(const T* in, const util::IndexMapper3D& index,
+                   const std::array<const AxisSampling*, 3>& axes, const size3_t& pos) {
+    const auto& xs = *axes[0];
+    const auto& ys = *axes[1];
+    const auto& zs = *axes[2];
+
+    if constexpr (M == Method::PiecewiseConstant) {
+        return static_cast<double>(in[index(xs.i0[pos.x], ys.i0[pos.y], zs.i0[pos.z])]);
+    } else if constexpr (M == Method::Triquadratic) {
+        const std::array<size_t, 3> x = {xs.i0[pos.x], xs.i1[pos.x], xs.i2[pos.x]};
+        const std::array<size_t, 3> y = {ys.i0[pos.y], ys.i1[pos.y], ys.i2[pos.y]};
+        const std::array<size_t, 3> z = {zs.i0[pos.z], zs.i1[pos.z], zs.i2[pos.z]};
+        std::array<double, 27> values;
+        for (size_t k = 0; k < 3; ++k) {
+            for (size_t j = 0; j < 3; ++j) {
+                for (size_t i = 0; i < 3; ++i) {
+                    values[i + 3 * j + 9 * k] = static_cast<double>(in[index(x[i], y[j], z[k])]);
+                }
+            }
+        }
+        return TNM067::Interpolation::triQuadratic(values, xs.t[pos.x], ys.t[pos.y], zs.t[pos.z]);
+    } else {
+        const std::array<size_t, 2> x = {xs.i0[pos.x], xs.i1[pos.x]};
+        const std::array<size_t, 2> y = {ys.i0[pos.y], ys.i1[pos.y]};
+        const std::array<size_t, 2> z = {zs.i0[pos.z], zs.i1[pos.z]};
+        std::array<double, 8> values;
+        for (size_t k = 0; k < 2; ++k) {
+            for (size_t j = 0; j < 2; ++j) {
+                for (size_t i = 0; i < 2; ++i) {
+                    values[i + 2 * j + 4 * k] = static_cast<double>(in[index(x[i], y[j], z[k])]);
+                }
+            }
+        }
+        if constexpr (M == Method::Trilinear) {
+            return TNM067::Interpolation::trilinear(values, xs.t[pos.x], ys.t[pos.y],
+                                                    zs.t[pos.z]);
+        } else {
+            return TNM067::Interpolation::tetrahedralBarycentric(values, xs.t[pos.x], ys.t[pos.y],
+                                                                 zs.t[pos.z]);
+        }
+    }
+}
+
+/*
+ * Resamples the volume brick by brick, the bricks are processed in parallel. A brick of the
+ * output reads a compact block of the input, which keeps the neighbourhood lookups in cache.
+ */
+template <Method M, typename T>
+void resample(const T* in, size3_t inDims, T* out, size3_t outDims) {
+    const AxisSampling xs(footprint(M), inDims.x, outDims.x);
+    const AxisSampling ys(footprint(M), inDims.y, outDims.y);
+    const AxisSampling zs(footprint(M), inDims.z, outDims.z);
+    const std::array<const AxisSampling*, 3> axes = {&xs, &ys, &zs};
+
+    const util::IndexMapper3D inIndex(inDims);
+    const util::IndexMapper3D outIndex(outDims);
+
+    const size_t brickSize = 16;
+    const size3_t numBricks = (outDims + size3_t(brickSize - 1)) / brickSize;
+
+    const size_t bricksPerLayer = numBricks.x * numBricks.y;
+    util::forEachIndexParallel(bricksPerLayer * numBricks.z, [&](size_t b) {
+        const size_t layerBrick = b % bricksPerLayer;
+        const size3_t brick(layerBrick % numBricks.x, layerBrick / numBricks.x, b / bricksPerLayer);
+        const size3_t begin = brick * brickSize;
+        const size3_t end = glm::min(begin + size3_t(brickSize), outDims);
+        for (size_t z = begin.z; z < end.z; ++z) {
+            for (size_t y = begin.y; y < end.y; ++y) {
+                for (size_t x = begin.x; x < end.x; ++x) {
+                    const size3_t pos(x, y, z);
+                    out[outIndex(pos)] = toVoxel<T>(interpolate<M>(in, inIndex, axes, pos));
+                }
+            }
+        }
+    });
+}
+
+}  // namespace
+
+const ProcessorInfo VolumeResampler::processorInfo_{
+    "org.inviwo.VolumeResampler",  // Class identifier
+    "Volume Resampler",            // Display name
+    "TNM067",                      // Category
+    CodeState::Experimental,       // Code state
+    Tags::CPU,                     // Tags
+};
+const ProcessorInfo VolumeResampler::getProcessorInfo() const { return processorInfo_; }
+
+VolumeResampler::VolumeResampler()
+    : Processor()
+    , inport_("inport")
+    , outport_("outport")
+    , interpolationMethod_("interpolationMethod", "Interpolation Method",
+                           {
+                               {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+                                InterpolationMethod::PiecewiseConstant},
+                               {"trilinear", "Trilinear", InterpolationMethod::Trilinear},
+                               {"triquadratic", "Triquadratic", InterpolationMethod::Triquadratic},
+                               {"barycentric", "Tetrahedral Barycentric",
+                                InterpolationMethod::Barycentric},
+                           },
+                           1)
+    , dimensions_("dimensions", "Dimensions", size3_t(64), size3_t(2), size3_t(1024)) {
+    addPort(inport_);
+    addPort(outport_);
+    addProperty(interpolationMethod_);
+    addProperty(dimensions_);
+}
+
+void VolumeResampler::process() {
+    ScopedTimer timer("VolumeResampler::process");
+    auto inVolume = inport_.getData();
+    const size3_t inDims = inVolume->getDimensions();
+    const size3_t outDims = dimensions_.get();
+
+    auto outVolume = std::make_shared<Volume>(outDims, inVolume->getDataFormat());
+    outVolume->setModelMatrix(inVolume->getModelMatrix());
+    outVolume->setWorldMatrix(inVolume->getWorldMatrix());
+    outVolume->dataMap_ = inVolume->dataMap_;
+
+    outVolume->getEditableRepresentation<VolumeRAM>()
+        ->dispatch<void, dispatching::filter::Scalars>([&](auto outRep) {
+            using T = util::PrecisionValueType<decltype(outRep)>;
+            const T* in =
+                static_cast<const T*>(inVolume->getRepresentation<VolumeRAM>()->getData());
+            T* out = outRep->getDataTyped();
+            switch (interpolationMethod_.get()) {
+                case Method::PiecewiseConstant:
+                    resample<Method::PiecewiseConstant>(in, inDims, out, outDims);
+                    break;
+                case Method::Trilinear:
+                    resample<Method::Trilinear>(in, inDims, out, outDims);
+                    break;
+                case Method::Triquadratic:
+                    resample<Method::Triquadratic>(in, inDims, out, outDims);
+                    break;
+                case Method::Barycentric:
+                    resample<Method::Barycentric>(in, inDims, out, outDims);
+                    break;
+                default:
+                    break;
+            }
+        });
+
+    Tracer::get().addCounter("VolumeResampler voxels resampled",
+                             static_cast<int64_t>(outDims.x * outDims.y * outDims.z));
+    outport_.setData(outVolume);
+}
+
+}  // namespace inviwo
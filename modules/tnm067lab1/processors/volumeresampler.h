@@ -0,0 +1,39 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/ports/volumeport.h>
+
+namespace inviwo {
+
+/**
+ * \class VolumeResampler
+ * \brief Resamples a scalar volume to a given size on the CPU
+ *
+ * The volume is resampled with the 3D versions of the TNM067 interpolation methods, using the
+ * same voxel center convention as ImageUpsampler. The output keeps the basis, offset and data
+ * mapping of the input.
+ */
+class IVW_MODULE_TNM067LAB1_API VolumeResampler : public Processor {
+public:
+    enum class InterpolationMethod { PiecewiseConstant, Trilinear, Triquadratic, Barycentric };
+
+    VolumeResampler();
+    virtual ~VolumeResampler() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    VolumeInport inport_;
+    VolumeOutport outport_;
+
+    TemplateOptionProperty<InterpolationMethod> interpolationMethod_;
+    IntSize3Property dimensions_;
+};
+
+}  // namespace inviwo
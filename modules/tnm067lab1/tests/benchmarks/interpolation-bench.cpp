@@ -0,0 +1,208 @@
+/*
+ * Micro-benchmarks of the interpolation kernels in interpolationmethods.h and of
+ * ScalarToColorMapping, for float, double, dvec2, dvec3 and dvec4 and working sets from L1
+ * resident (256 samples) to streaming from memory (1M samples). The vectors are double precision
+ * since the kernels compute their weights in double, which is also how ImageUpsampler uses them.
+ * The inputs are generated from a fixed seed, so runs are comparable between builds.
+ *
+ * Every benchmark reports ns/sample and GB/s (the rate counter "GB"), where the bytes are the
+ * ones streamed per sample: one new value, the sample positions and the result. The kernels read
+ * overlapping windows of consecutive values, so the other values of a sample are already cached.
+ *
+ * The benchmarks use Google Benchmark and are built as tnm067lab1-benchmark when
+ * IVW_TEST_BENCHMARKS is enabled, see tests/benchmarks/CMakeLists.txt. Run them in a release
+ * build, for example with --benchmark_format=json to compare runs.
+ */
+
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <benchmark/benchmark.h>
+#include <warn/pop>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+constexpr unsigned seed = 67;
+
+template <typename T>
+T randomValue(std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<T>(dist(rng));
+    } else {
+        T v{};
+        for (glm::length_t i = 0; i < T::length(); ++i) {
+            v[i] = static_cast<typename T::value_type>(dist(rng));
+        }
+        return v;
+    }
+}
+
+template <typename T>
+std::vector<T> randomValues(size_t size, unsigned offset) {
+    std::mt19937 rng(seed + offset);
+    std::vector<T> values(size);
+    for (auto& v : values) v = randomValue<T>(rng);
+    return values;
+}
+
+// Positions slightly outside of [0, 1] as well, so that the clamping is part of the timings
+template <typename F>
+std::vector<F> randomPositions(size_t size, unsigned offset) {
+    std::mt19937 rng(seed + offset);
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+    std::vector<F> positions(size);
+    for (auto& p : positions) p = static_cast<F>(dist(rng));
+    return positions;
+}
+
+template <size_t N, typename T>
+std::array<T, N> window(const T* v) {
+    std::array<T, N> res;
+    for (size_t i = 0; i < N; ++i) res[i] = v[i];
+    return res;
+}
+
+void setCounters(benchmark::State& state, size_t numSamples, size_t bytesPerSample) {
+    const double samples = static_cast<double>(state.iterations()) * numSamples;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["ns/sample"] = benchmark::Counter(
+        samples * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["GB"] =
+        benchmark::Counter(samples * bytesPerSample * 1e-9, benchmark::Counter::kIsRate);
+}
+
+/*
+ * Times kernel(values + i, x[i], y[i]) for the number of samples given by the first argument of
+ * the benchmark. numPositions is the number of the positions x and y that the kernel reads.
+ */
+template <typename T, typename Kernel>
+void runKernel(benchmark::State& state, size_t numPositions, Kernel kernel) {
+    using F = typename float_type<T>::type;
+    const size_t numSamples = static_cast<size_t>(state.range(0));
+    const auto values = randomValues<T>(numSamples + 8, 0);
+    const auto x = randomPositions<F>(numSamples, 1);
+    const auto y = randomPositions<F>(numSamples, 2);
+    std::vector<T> out(numSamples);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < numSamples; ++i) out[i] = kernel(values.data() + i, x[i], y[i]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, numSamples, 2 * sizeof(T) + numPositions * sizeof(F));
+}
+
+template <typename T>
+void BM_Linear(benchmark::State& state) {
+    runKernel<T>(state, 1, [](const T* v, auto x, auto) {
+        return TNM067::Interpolation::linear(v[0], v[1], x);
+    });
+}
+
+template <typename T>
+void BM_Bilinear(benchmark::State& state) {
+    runKernel<T>(state, 2, [](const T* v, auto x, auto y) {
+        return TNM067::Interpolation::bilinear(window<4>(v), x, y);
+    });
+}
+
+template <typename T>
+void BM_Quadratic(benchmark::State& state) {
+    runKernel<T>(state, 1, [](const T* v, auto x, auto) {
+        return TNM067::Interpolation::quadratic(v[0], v[1], v[2], x);
+    });
+}
+
+template <typename T>
+void BM_BiQuadratic(benchmark::State& state) {
+    runKernel<T>(state, 2, [](const T* v, auto x, auto y) {
+        return TNM067::Interpolation::biQuadratic(window<9>(v), x, y);
+    });
+}
+
+template <typename T>
+void BM_Barycentric(benchmark::State& state) {
+    runKernel<T>(state, 2, [](const T* v, auto x, auto y) {
+        return TNM067::Interpolation::barycentric(window<4>(v), x, y);
+    });
+}
+
+ScalarToColorMapping createColorMapping(size_t lookupTableSize) {
+    ScalarToColorMapping map;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t i = 0; i < 10; ++i) {
+        map.addBaseColors(vec4(dist(rng), dist(rng), dist(rng), 1.0f));
+    }
+    map.setLookupTableSize(lookupTableSize);
+    return map;
+}
+
+// Arguments: number of samples, size of the lookup table (0 interpolates the base colors)
+void BM_ColorMappingSample(benchmark::State& state) {
+    const size_t numSamples = static_cast<size_t>(state.range(0));
+    const auto map = createColorMapping(static_cast<size_t>(state.range(1)));
+    const auto t = randomPositions<float>(numSamples, 1);
+    std::vector<vec4> colors(numSamples);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < numSamples; ++i) colors[i] = map.sample(t[i]);
+        benchmark::DoNotOptimize(colors.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, numSamples, sizeof(float) + sizeof(vec4));
+}
+
+void BM_ColorMappingSampleBatch(benchmark::State& state) {
+    const size_t numSamples = static_cast<size_t>(state.range(0));
+    const auto map = createColorMapping(static_cast<size_t>(state.range(1)));
+    const auto t = randomPositions<float>(numSamples, 1);
+    std::vector<vec4> colors(numSamples);
+
+    for (auto _ : state) {
+        map.sampleBatch(t, colors);
+        benchmark::DoNotOptimize(colors.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, numSamples, sizeof(float) + sizeof(vec4));
+}
+
+// From L1 resident to streaming from memory for all types
+void workingSets(benchmark::internal::Benchmark* b) {
+    b->ArgName("samples")->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+}
+
+void colorMappingArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"samples", "lut"})->ArgsProduct({{1 << 8, 1 << 12, 1 << 16, 1 << 20}, {0, 256}});
+}
+
+}  // namespace
+
+#define TNM067_INTERPOLATION_BENCHMARK(kernel)              \
+    BENCHMARK_TEMPLATE(kernel, float)->Apply(workingSets);  \
+    BENCHMARK_TEMPLATE(kernel, double)->Apply(workingSets); \
+    BENCHMARK_TEMPLATE(kernel, dvec2)->Apply(workingSets);  \
+    BENCHMARK_TEMPLATE(kernel, dvec3)->Apply(workingSets);  \
+    BENCHMARK_TEMPLATE(kernel, dvec4)->Apply(workingSets)
+
+TNM067_INTERPOLATION_BENCHMARK(BM_Linear);
+TNM067_INTERPOLATION_BENCHMARK(BM_Bilinear);
+TNM067_INTERPOLATION_BENCHMARK(BM_Quadratic);
+TNM067_INTERPOLATION_BENCHMARK(BM_BiQuadratic);
+TNM067_INTERPOLATION_BENCHMARK(BM_Barycentric);
+
+BENCHMARK(BM_ColorMappingSample)->Apply(colorMappingArgs);
+BENCHMARK(BM_ColorMappingSampleBatch)->Apply(colorMappingArgs);
+
+}  // namespace inviwo
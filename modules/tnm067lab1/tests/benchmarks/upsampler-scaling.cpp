@@ -0,0 +1,145 @@
+/*
+ * Thread scaling of ImageUpsampler. For every interpolation method a float image is upsampled by
+ * four along each axis with the thread pool of the application resized from 1 to the number of
+ * hardware threads. The processor is fed through its inport, without a processor network, a GUI
+ * or an OpenGL context, and only process() is timed.
+ *
+ * Every method and pool size is written to stdout as one line of JSON with the wall times of the
+ * runs in seconds, the output pixels per second and the speedup and parallel efficiency relative
+ * to the median time with one thread.
+ *
+ *     tnm067-upsampler-scaling [runs = 5] [output size = 4096] [threads = hardware threads]
+ *
+ * The output is square with the given size and the input a quarter of it along each axis. The
+ * pool is resized up to the given number of threads. The target is defined in
+ * tests/benchmarks/CMakeLists.txt, which is added by add_subdirectory(tests/benchmarks) in the
+ * CMakeLists.txt of the module. Run it in a release build on an otherwise idle machine.
+ */
+
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/datastructures/image/image.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/ports/imageport.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/util/consolelogger.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/logcentral.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace inviwo;
+
+namespace {
+
+void check(bool condition, const std::string& message) {
+    if (!condition) throw Exception(message, IVW_CONTEXT_CUSTOM("UpsamplerScaling"));
+}
+
+// Smooth test data with values in [0, 1], the same as in the processor throughput harness
+std::shared_ptr<Image> createImage(size2_t dims) {
+    auto image = std::make_shared<Image>(dims, DataFloat32::get());
+    auto layer = static_cast<LayerRAMPrecision<float>*>(
+        image->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const vec2 p = vec2(x, y) / vec2(dims) * 20.0f;
+            layer->getDataTyped()[x + y * dims.x] =
+                0.5f + 0.25f * (std::sin(p.x) + std::cos(1.3f * p.y));
+        }
+    }
+    return image;
+}
+
+struct Timings {
+    double min;
+    double median;
+    double max;
+};
+
+Timings timeRuns(ImageUpsampler& upsampler, ImageOutport& outport, size2_t dims, size_t runs) {
+    std::vector<double> seconds;
+    // The first run is not timed, it touches the memory of the outputs
+    for (size_t i = 0; i <= runs; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        upsampler.process();
+        const auto end = std::chrono::steady_clock::now();
+        if (i > 0) seconds.push_back(std::chrono::duration<double>(end - start).count());
+
+        auto image = outport.getData();
+        check(image && image->getDimensions() == dims, "ImageUpsampler output size");
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return {seconds.front(), seconds[seconds.size() / 2], seconds.back()};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    LogCentral::init();
+    auto logger = std::make_shared<ConsoleLogger>();
+    LogCentral::getPtr()->setVerbosity(LogVerbosity::Error);
+    LogCentral::getPtr()->registerLogger(logger);
+
+    const size_t runs = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 5;
+    const size_t size = argc > 2 ? std::max(std::atoi(argv[2]), 4) : 4096;
+    const size_t maxThreads = argc > 3 ? std::max(std::atoi(argv[3]), 1)
+                                       : std::max(std::thread::hardware_concurrency(), 1u);
+
+    // ImageUpsampler splits its output tiles over the thread pool of the application
+    InviwoApplication app(argc, argv, "TNM067 Upsampler Scaling");
+
+    const size2_t inputDims(size / 4);
+    const size2_t dims(size);
+    auto source = std::make_unique<ImageOutport>("source");
+    source->setData(createImage(inputDims));
+
+    try {
+        for (const std::string method :
+             {"piecewiseconstant", "bilinear", "quadratic", "barycentric"}) {
+            ImageUpsampler upsampler;
+            auto inport = upsampler.getInport("inport");
+            auto outport = dynamic_cast<ImageOutport*>(upsampler.getOutport("outport"));
+            check(inport && outport, "No inport or outport");
+            inport->connectTo(source.get());
+            outport->setDimensions(dims);
+            auto property = dynamic_cast<BaseOptionProperty*>(
+                upsampler.getPropertyByIdentifier("interpolationMethod"));
+            check(property != nullptr, "No property interpolationMethod");
+            property->setSelectedIdentifier(method);
+
+            double serial = 0.0;
+            for (size_t threads = 1; threads <= maxThreads; ++threads) {
+                app.resizePool(threads);
+                const auto t = timeRuns(upsampler, *outport, dims, runs);
+                if (threads == 1) serial = t.median;
+
+                std::ostringstream json;
+                json << "{\"processor\":\"ImageUpsampler\",\"method\":\"" << method
+                     << "\",\"input\":[" << inputDims.x << "," << inputDims.y << "],\"output\":["
+                     << dims.x << "," << dims.y << "],\"threads\":" << threads
+                     << ",\"runs\":" << runs << ",\"seconds\":{\"min\":" << t.min
+                     << ",\"median\":" << t.median << ",\"max\":" << t.max
+                     << "},\"pixelsPerSecond\":" << dims.x * dims.y / t.median
+                     << ",\"speedup\":" << serial / t.median
+                     << ",\"efficiency\":" << serial / t.median / threads << "}";
+                std::cout << json.str() << std::endl;
+            }
+            inport->disconnectFrom(source.get());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
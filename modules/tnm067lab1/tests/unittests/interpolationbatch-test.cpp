@@ -0,0 +1,165 @@
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+constexpr size_t numSamples = 1000;
+
+// Positions slightly outside of [0, 1] as well, to cover the clamping
+std::vector<double> randomPositions(std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+    std::vector<double> positions(numSamples);
+    for (auto& p : positions) p = dist(rng);
+    return positions;
+}
+
+template <size_t N>
+std::vector<std::array<double, N>> randomValues(std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::vector<std::array<double, N>> values(numSamples);
+    for (auto& v : values) {
+        for (auto& e : v) e = dist(rng);
+    }
+    return values;
+}
+
+template <size_t N>
+std::vector<double> component(const std::vector<std::array<double, N>>& values, size_t i) {
+    std::vector<double> res(values.size());
+    for (size_t j = 0; j < values.size(); ++j) res[j] = values[j][i];
+    return res;
+}
+
+}  // namespace
+
+TEST(InterpolationBatch, LinearMatchesSingleSample) {
+    std::mt19937 rng(1);
+    const auto values = randomValues<2>(rng);
+    const auto a = component(values, 0);
+    const auto b = component(values, 1);
+    const auto x = randomPositions(rng);
+
+    std::vector<double> out(numSamples);
+    TNM067::Interpolation::linear(a, b, x, out);
+    for (size_t i = 0; i < numSamples; ++i) {
+        EXPECT_EQ(TNM067::Interpolation::linear(a[i], b[i], x[i]), out[i]) << "sample " << i;
+    }
+}
+
+TEST(InterpolationBatch, BilinearMatchesSingleSample) {
+    std::mt19937 rng(2);
+    const auto v = randomValues<4>(rng);
+    const auto x = randomPositions(rng);
+    const auto y = randomPositions(rng);
+
+    std::vector<double> out(numSamples);
+    TNM067::Interpolation::bilinear(v, x, y, out);
+    for (size_t i = 0; i < numSamples; ++i) {
+        EXPECT_EQ(TNM067::Interpolation::bilinear(v[i], x[i], y[i]), out[i]) << "sample " << i;
+    }
+}
+
+TEST(InterpolationBatch, QuadraticMatchesSingleSample) {
+    std::mt19937 rng(3);
+    const auto values = randomValues<3>(rng);
+    const auto a = component(values, 0);
+    const auto b = component(values, 1);
+    const auto c = component(values, 2);
+    const auto x = randomPositions(rng);
+
+    std::vector<double> out(numSamples);
+    TNM067::Interpolation::quadratic(a, b, c, x, out);
+    for (size_t i = 0; i < numSamples; ++i) {
+        EXPECT_EQ(TNM067::Interpolation::quadratic(a[i], b[i], c[i], x[i]), out[i])
+            << "sample " << i;
+    }
+}
+
+TEST(InterpolationBatch, BiQuadraticMatchesSingleSample) {
+    std::mt19937 rng(4);
+    const auto v = randomValues<9>(rng);
+    const auto x = randomPositions(rng);
+    const auto y = randomPositions(rng);
+
+    std::vector<double> out(numSamples);
+    TNM067::Interpolation::biQuadratic(v, x, y, out);
+    for (size_t i = 0; i < numSamples; ++i) {
+        EXPECT_EQ(TNM067::Interpolation::biQuadratic(v[i], x[i], y[i]), out[i])
+            << "sample " << i;
+    }
+}
+
+TEST(InterpolationBatch, BarycentricMatchesSingleSample) {
+    std::mt19937 rng(5);
+    const auto v = randomValues<4>(rng);
+    const auto x = randomPositions(rng);
+    const auto y = randomPositions(rng);
+
+    std::vector<double> out(numSamples);
+    TNM067::Interpolation::barycentric(v, x, y, util::span<double>(out));
+    for (size_t i = 0; i < numSamples; ++i) {
+        EXPECT_EQ(TNM067::Interpolation::barycentric(v[i], x[i], y[i]), out[i])
+            << "sample " << i;
+    }
+}
+
+TEST(InterpolationFixedPoint, MatchesFloatingPointForUInt8) {
+    namespace FP = TNM067::Interpolation::FixedPoint;
+    std::mt19937 rng(6);
+    std::uniform_int_distribution<int> valueDist(0, 255);
+    std::uniform_real_distribution<double> posDist(0.0, 1.0);
+
+    auto clampToU8 = [](double v) { return std::min(std::max(v, 0.0), 255.0); };
+    for (size_t i = 0; i < numSamples; ++i) {
+        std::array<uint8_t, 9> v;
+        std::array<double, 9> d;
+        for (size_t j = 0; j < 9; ++j) {
+            v[j] = static_cast<uint8_t>(valueDist(rng));
+            d[j] = v[j];
+        }
+        const double x = posDist(rng);
+        const double y = posDist(rng);
+        const int32_t fx = FP::fraction(x);
+        const int32_t fy = FP::fraction(y);
+
+        const std::array<uint8_t, 4> v4{v[0], v[1], v[2], v[3]};
+        const std::array<double, 4> d4{d[0], d[1], d[2], d[3]};
+        EXPECT_NEAR(TNM067::Interpolation::linear(d[0], d[1], x), FP::linear(v[0], v[1], fx), 1.0);
+        EXPECT_NEAR(TNM067::Interpolation::bilinear(d4, x, y), FP::bilinear(v4, fx, fy), 1.0);
+        EXPECT_NEAR(TNM067::Interpolation::barycentric(d4, x, y), FP::barycentric(v4, fx, fy),
+                    1.0);
+        EXPECT_NEAR(clampToU8(TNM067::Interpolation::quadratic(d[0], d[1], d[2], x)),
+                    FP::quadratic(v[0], v[1], v[2], fx), 1.0);
+        EXPECT_NEAR(clampToU8(TNM067::Interpolation::biQuadratic(d, x, y)),
+                    FP::biQuadratic(v, fx, fy), 1.0);
+    }
+}
+
+TEST(InterpolationFixedPoint, ClampsPositions) {
+    namespace FP = TNM067::Interpolation::FixedPoint;
+    const std::array<uint8_t, 4> v{10, 200, 30, 120};
+    const int32_t below = FP::fraction(-0.5);
+    const int32_t above = FP::fraction(1.5);
+    const int32_t zero = FP::fraction(0.0);
+    const int32_t one = FP::fraction(1.0);
+
+    EXPECT_EQ(FP::linear(v[0], v[1], zero), FP::linear(v[0], v[1], below));
+    EXPECT_EQ(FP::linear(v[0], v[1], one), FP::linear(v[0], v[1], above));
+    EXPECT_EQ(FP::bilinear(v, zero, one), FP::bilinear(v, below, above));
+    EXPECT_EQ(FP::barycentric(v, zero, one), FP::barycentric(v, below, above));
+    EXPECT_EQ(FP::barycentric(v, one, zero), FP::barycentric(v, above, below));
+    EXPECT_EQ(FP::barycentric(v, one, one), FP::barycentric(v, above, above));
+}
+
+}  // namespace inviwo
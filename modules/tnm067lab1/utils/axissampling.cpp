@@ -0,0 +1,38 @@
+#include <modules/tnm067lab1/utils/axissampling.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <inviwo/core/util/glm.h>
+
+#include <cmath>
+
+namespace inviwo {
+
+AxisSampling::AxisSampling(Footprint footprint, size_t inputSize, size_t outputSize)
+    : i0(outputSize), i1(outputSize), i2(outputSize), t(outputSize) {
+    auto clampIndex = [&](int i) -> size_t {
+        return static_cast<size_t>(glm::clamp(i, 0, static_cast<int>(inputSize) - 1));
+    };
+
+    for (size_t o = 0; o < outputSize; ++o) {
+        // Relative coordinate of the output sample in the input, might be between samples
+        const double c = ImageUpsampler::convertCoordinate(
+            ivec2(static_cast<int>(o)), size2_t(inputSize), size2_t(outputSize))[0];
+
+        if (footprint == Footprint::Nearest) {
+            i0[o] = clampIndex(static_cast<int>(std::floor(c)));
+            i1[o] = i2[o] = i0[o];
+            t[o] = 0.0;
+        } else {
+            // Position relative to the sample centers, truncated towards zero
+            const double p = c - 0.5;
+            const int first = static_cast<int>(p);
+            i0[o] = clampIndex(first);
+            i1[o] = clampIndex(first + 1);
+            i2[o] = clampIndex(first + 2);
+            t[o] = p - first;
+            // The quadratic footprint spans three samples, i.e. two units
+            if (footprint == Footprint::Quadratic) t[o] /= 2.0;
+        }
+    }
+}
+
+}  // namespace inviwo
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \brief Precomputed sampling of an input along one axis when resampling it to another size
+ *
+ * For every output coordinate i0, i1 and i2 hold the input indices of the interpolation
+ * footprint, already clamped to the input, and t the fractional position within the footprint.
+ * Computed once per (input size, output size) pair so that no coordinate conversion or clamping
+ * is needed per output sample. Shared by ImageUpsampler and VolumeResampler, the output
+ * coordinates are converted to input coordinates with ImageUpsampler::convertCoordinate.
+ */
+struct IVW_MODULE_TNM067LAB1_API AxisSampling {
+    /**
+     * Number of input samples interpolated along the axis: Nearest reads only i0 with t = 0,
+     * Linear reads i0 and i1 and Quadratic reads i0 to i2 with t relative to the span of two
+     * units between i0 and i2.
+     */
+    enum class Footprint { Nearest, Linear, Quadratic };
+
+    AxisSampling(Footprint footprint, size_t inputSize, size_t outputSize);
+
+    std::vector<size_t> i0;
+    std::vector<size_t> i1;
+    std::vector<size_t> i2;
+    std::vector<double> t;
+};
+
+}  // namespace inviwo
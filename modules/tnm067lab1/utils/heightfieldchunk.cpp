@@ -0,0 +1,151 @@
+#include <modules/tnm067lab1/utils/heightfieldchunk.h>
+#include <inviwo/core/util/assertion.h>
+
+#include <algorithm>
+
+namespace inviwo {
+
+namespace {
+
+// Image coordinate origin + i - 1 clamped to [0, size - 1], i.e. i indexes a sample with apron
+size_t apronCoordinate(size_t origin, size_t i, size_t size) {
+    return std::min(std::max(origin + i, size_t{1}) - 1, size - 1);
+}
+
+/*
+ * Visits all samples of the chunk at origin with the given size including the one sample apron,
+ * clamped to the image. x and y are in [0, size + 2], sample (1, 1) is the one at the origin.
+ */
+template <typename C>
+void forEachSample(const std::vector<float>& imageValues, size2_t imageDims, size2_t origin,
+                   size_t size, C callback) {
+    for (size_t y = 0; y <= size + 2; ++y) {
+        const size_t row = apronCoordinate(origin.y, y, imageDims.y) * imageDims.x;
+        for (size_t x = 0; x <= size + 2; ++x) {
+            callback(x, y, imageValues[row + apronCoordinate(origin.x, x, imageDims.x)]);
+        }
+    }
+}
+
+size2_t chunkExtent(size2_t imageDims, size2_t origin, size_t size) {
+    return glm::min(size2_t(size), imageDims - size2_t(1) - origin);
+}
+
+}  // namespace
+
+HeightfieldChunk::HeightfieldChunk(const std::vector<float>& imageValues, size2_t imageDims,
+                                   size2_t origin, size_t size)
+    : imageDims_{imageDims}
+    , origin_{origin}
+    , size_{size}
+    , extent_{chunkExtent(imageDims, origin, size)}
+    , samples_((size + 3) * (size + 3)) {
+    IVW_ASSERT(size > 0 && (size & (size - 1)) == 0, "Chunk size has to be a power of two");
+    IVW_ASSERT(origin.x < imageDims.x && origin.y < imageDims.y, "Chunk outside of the image");
+
+    forEachSample(imageValues, imageDims, origin, size,
+                  [&](size_t x, size_t y, float v) { samples_[x + y * (size + 3)] = v; });
+
+    // Level 0, every cell spans the four samples at its corners
+    Level level0{size, std::vector<float>(size * size), std::vector<float>(size * size)};
+    for (size_t y = 0; y < size; ++y) {
+        for (size_t x = 0; x < size; ++x) {
+            const float s00 = getSample(x, y);
+            const float s10 = getSample(x + 1, y);
+            const float s01 = getSample(x, y + 1);
+            const float s11 = getSample(x + 1, y + 1);
+            level0.min[x + y * size] = std::min({s00, s10, s01, s11});
+            level0.max[x + y * size] = std::max({s00, s10, s01, s11});
+        }
+    }
+    levels_.push_back(std::move(level0));
+
+    // Coarser levels by 2x2 min/max reduction
+    while (levels_.back().cells > 1) {
+        const Level& fine = levels_.back();
+        const size_t cells = fine.cells / 2;
+        Level coarse{cells, std::vector<float>(cells * cells), std::vector<float>(cells * cells)};
+        for (size_t y = 0; y < cells; ++y) {
+            for (size_t x = 0; x < cells; ++x) {
+                const size_t f0 = 2 * x + 2 * y * fine.cells;
+                const size_t f1 = f0 + fine.cells;
+                coarse.min[x + y * cells] = std::min(
+                    {fine.min[f0], fine.min[f0 + 1], fine.min[f1], fine.min[f1 + 1]});
+                coarse.max[x + y * cells] = std::max(
+                    {fine.max[f0], fine.max[f0 + 1], fine.max[f1], fine.max[f1 + 1]});
+            }
+        }
+        levels_.push_back(std::move(coarse));
+    }
+
+    // Level l is rendered as a grid through every 2^l:th sample. Within a cell that surface stays
+    // between the smallest and largest corner sample, while the real samples stay between the
+    // cell minimum and maximum, which bounds the vertical error of the cell.
+    errors_.resize(levels_.size(), 0.0f);
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        const Level& level = levels_[l];
+        const size_t stride = size_t{1} << l;
+        float error = errors_[l - 1];
+        for (size_t y = 0; y < level.cells; ++y) {
+            for (size_t x = 0; x < level.cells; ++x) {
+                const float c00 = getSample(x * stride, y * stride);
+                const float c10 = getSample((x + 1) * stride, y * stride);
+                const float c01 = getSample(x * stride, (y + 1) * stride);
+                const float c11 = getSample((x + 1) * stride, (y + 1) * stride);
+                const float patchMin = std::min({c00, c10, c01, c11});
+                const float patchMax = std::max({c00, c10, c01, c11});
+                const size_t i = x + y * level.cells;
+                error = std::max({error, level.max[i] - patchMin, patchMax - level.min[i]});
+            }
+        }
+        errors_[l] = error;
+    }
+}
+
+bool HeightfieldChunk::matches(const std::vector<float>& imageValues, size2_t imageDims,
+                               size2_t origin, size_t size) const {
+    if (imageDims != imageDims_ || origin != origin_ || size != size_) return false;
+    bool equal = true;
+    forEachSample(imageValues, imageDims, origin, size, [&](size_t x, size_t y, float v) {
+        equal = equal && v == getApronSample(x, y);
+    });
+    return equal;
+}
+
+size2_t HeightfieldChunk::getOrigin() const { return origin_; }
+size_t HeightfieldChunk::getSize() const { return size_; }
+size2_t HeightfieldChunk::getExtent() const { return extent_; }
+
+float HeightfieldChunk::getSample(size_t x, size_t y) const {
+    return getApronSample(x + 1, y + 1);
+}
+
+float HeightfieldChunk::getApronSample(size_t x, size_t y) const {
+    return samples_[x + y * (size_ + 3)];
+}
+
+vec2 HeightfieldChunk::getGradient(size_t x, size_t y) const {
+    const size2_t pos = origin_ + size2_t(x, y);
+    // Neighbours in apron coordinates, the sample itself at the image border
+    const size2_t prev(pos.x > 0 ? x : x + 1, pos.y > 0 ? y : y + 1);
+    const size2_t next(pos.x + 1 < imageDims_.x ? x + 2 : x + 1,
+                       pos.y + 1 < imageDims_.y ? y + 2 : y + 1);
+    const vec2 step(glm::max(next - prev, size2_t(1)));
+    return vec2(getApronSample(next.x, y + 1) - getApronSample(prev.x, y + 1),
+                getApronSample(x + 1, next.y) - getApronSample(x + 1, prev.y)) /
+           step;
+}
+
+float HeightfieldChunk::getMin() const { return levels_.back().min.front(); }
+float HeightfieldChunk::getMax() const { return levels_.back().max.front(); }
+
+size_t HeightfieldChunk::getNumLevels() const { return levels_.size(); }
+float HeightfieldChunk::getError(size_t level) const { return errors_[level]; }
+
+size_t HeightfieldChunk::selectLevel(float tolerance) const {
+    size_t level = 0;
+    while (level + 1 < errors_.size() && errors_[level + 1] <= tolerance) ++level;
+    return level;
+}
+
+}  // namespace inviwo
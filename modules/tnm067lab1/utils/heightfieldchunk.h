@@ -0,0 +1,85 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <vector>
+#include <inviwo/core/util/glmvec.h>
+
+namespace inviwo {
+
+/**
+ * \class HeightfieldChunk
+ * \brief A square tile of a heightfield with a min/max pyramid for level-of-detail selection
+ *
+ * A chunk of size N (a power of two) covers the (N + 1) x (N + 1) pixel centers starting at its
+ * origin, neighbouring chunks share their border samples. Samples outside of the image are
+ * clamped to the image border. A one sample apron around these samples is kept as well, so that
+ * gradients at the chunk border match those of the neighbouring chunks. Level l of the pyramid
+ * consists of cells of 2^l x 2^l pixels and stores the minimum and maximum of the samples covered
+ * by each cell, from which the vertical error of representing the chunk with every 2^l:th sample
+ * is bounded.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldChunk {
+public:
+    HeightfieldChunk() = default;
+    HeightfieldChunk(const std::vector<float>& imageValues, size2_t imageDims, size2_t origin,
+                     size_t size);
+
+    /**
+     * True if this chunk was created for the same region and all image values inside of it are
+     * unchanged, i.e. the chunk can be reused for the new image.
+     */
+    bool matches(const std::vector<float>& imageValues, size2_t imageDims, size2_t origin,
+                 size_t size) const;
+
+    size2_t getOrigin() const;
+    size_t getSize() const;
+    /**
+     * Number of cells that lie inside of the image, equal to the size along both axes except for
+     * chunks at the right and bottom border of the image.
+     */
+    size2_t getExtent() const;
+    /**
+     * Sample at position (x, y) relative to the origin, x and y in [0, size].
+     */
+    float getSample(size_t x, size_t y) const;
+    /**
+     * Gradient of the image values per pixel at sample (x, y), from central differences of the
+     * full resolution image and one sided at the image border. Shared border samples therefore
+     * get the same gradient in all chunks, independent of the level of detail.
+     */
+    vec2 getGradient(size_t x, size_t y) const;
+    float getMin() const;
+    float getMax() const;
+
+    size_t getNumLevels() const;
+    /**
+     * Conservative bound of the maximal vertical distance between the full resolution samples
+     * and the surface spanned by every 2^level:th sample.
+     */
+    float getError(size_t level) const;
+    /**
+     * The coarsest level with an error of at most \p tolerance.
+     */
+    size_t selectLevel(float tolerance) const;
+
+private:
+    struct Level {
+        size_t cells;  // number of cells along each axis
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    // Sample (x, y) including the apron, x and y in [0, size + 2]
+    float getApronSample(size_t x, size_t y) const;
+
+    size2_t imageDims_{0};
+    size2_t origin_{0};
+    size_t size_ = 0;
+    size2_t extent_{0};
+    std::vector<float> samples_;  // (size + 3) x (size + 3) samples including the apron
+    std::vector<Level> levels_;
+    std::vector<float> errors_;
+};
+
+}  // namespace inviwo
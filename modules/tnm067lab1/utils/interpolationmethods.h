@@ -2,6 +2,15 @@
 
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/util/glm.h>
+#include <inviwo/core/util/span.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 
 namespace inviwo {
@@ -122,26 +131,17 @@ T biQuadratic(const std::array<T, 9>& v, F x, F y) {
 template <typename T, typename F = double>
 T barycentric(const std::array<T, 4>& v, F x, F y) {
 
-    T f_A, f_B, f_C;
-    F alfa, beta, gamma;
-
-    f_B = v[1];
-    f_C = v[2];
-
-    //Check which triangle
-    if (x + y > 1.0) {
-        // A = (1, 1) B = (1, 0) C = (1, 0);
-        f_A = v[3];
-        alfa = (x + y) - 1.0;
-        beta = 1.0 - y;
-        gamma = 1.0 - x;
-    } else {
-        // A = (0,0) B = (1,0) C = (1,0);
-        f_A = v[0];
-        alfa = 1.0 - (x + y);
-        beta = x;
-        gamma = y;
-    }
+    const T f_B = v[1];
+    const T f_C = v[2];
+
+    // Check which triangle, selected without branching so that batches of samples vectorize
+    const bool upper = x + y > 1.0;
+    // upper: A = (1, 1) B = (1, 0) C = (0, 1)
+    // lower: A = (0, 0) B = (1, 0) C = (0, 1)
+    const T f_A = upper ? v[3] : v[0];
+    const F alfa = upper ? F((x + y) - 1.0) : F(1.0 - (x + y));
+    const F beta = upper ? F(1.0 - y) : x;
+    const F gamma = upper ? F(1.0 - x) : y;
 
     T f = alfa * f_A + beta * f_B + gamma * f_C;
 
@@ -163,6 +163,198 @@ T barycentric(const std::array<T, 4>& v, F x, F y) {
     */
 }
 
+// clang-format off
+    /*
+        6-------7
+       /|      /|
+      4-------5 |
+      | 2-----|-3
+    z |/      |/ y
+      0-------1
+          x
+    */
+// clang-format on
+template <typename T, typename F = double>
+T trilinear(const std::array<T, 8>& v, F x, F y, F z) {
+    const T f1 = bilinear(std::array<T, 4>{v[0], v[1], v[2], v[3]}, x, y);
+    const T f2 = bilinear(std::array<T, 4>{v[4], v[5], v[6], v[7]}, x, y);
+    return linear(f1, f2, z);
+}
+
+/*
+ * The 3x3x3 neighbourhood as three 3x3 slices ordered as in biQuadratic, i.e. v[x + 3y + 9z]
+ */
+template <typename T, typename F = double>
+T triQuadratic(const std::array<T, 27>& v, F x, F y, F z) {
+    std::array<T, 3> slices;
+    for (size_t i = 0; i < 3; ++i) {
+        std::array<T, 9> slice;
+        std::copy(v.begin() + 9 * i, v.begin() + 9 * (i + 1), slice.begin());
+        slices[i] = biQuadratic(slice, x, y);
+    }
+    return quadratic(slices[0], slices[1], slices[2], z);
+}
+
+/*
+ * Barycentric interpolation in the tetrahedra of the cube, ordered as in trilinear. The cube is
+ * split into six tetrahedra along the diagonal from 0 to 7, the tetrahedron containing (x, y, z)
+ * is given by the order of the coordinates. Its corners are found by walking from corner 0 to
+ * corner 7 along the axes in order of decreasing coordinate, and the weights are the differences
+ * between the sorted coordinates.
+ */
+template <typename T, typename F = double>
+T tetrahedralBarycentric(const std::array<T, 8>& v, F x, F y, F z) {
+    // Index step and coordinate of the three axes
+    std::array<std::pair<F, size_t>, 3> axes = {
+        std::pair<F, size_t>{x, 1}, std::pair<F, size_t>{y, 2}, std::pair<F, size_t>{z, 4}};
+    if (axes[0].first < axes[1].first) std::swap(axes[0], axes[1]);
+    if (axes[1].first < axes[2].first) std::swap(axes[1], axes[2]);
+    if (axes[0].first < axes[1].first) std::swap(axes[0], axes[1]);
+
+    const size_t c1 = axes[0].second;
+    const size_t c2 = c1 + axes[1].second;
+
+    T f = F(1.0 - axes[0].first) * v[0] + F(axes[0].first - axes[1].first) * v[c1] +
+          F(axes[1].first - axes[2].first) * v[c2] + axes[2].first * v[7];
+    return f;
+}
+
+/*
+ * Batch versions, evaluating out[i] from the i:th values and sample position of the inputs. The
+ * arguments can be any containers with size() and operator[], e.g. std::vector, std::array or
+ * util::span, and must all have the same size. linear and bilinear clamp the positions instead of
+ * returning early, which gives the same results as the single sample versions, so none of the
+ * loops contain branches other than selects. They are plain loops without intrinsics, whether
+ * they are vectorized is up to the compiler.
+ */
+template <typename A, typename B, typename X, typename Out>
+void linear(const A& a, const B& b, const X& x, Out&& out) {
+    using F = std::decay_t<decltype(x[0])>;
+    for (size_t i = 0; i < out.size(); ++i) {
+        const F t = std::min(std::max(x[i], F(0)), F(1));
+        out[i] = (F(1) - t) * a[i] + t * b[i];
+    }
+}
+
+template <typename V, typename X, typename Y, typename Out>
+void bilinear(const V& v, const X& x, const Y& y, Out&& out) {
+    using F = std::decay_t<decltype(x[0])>;
+    for (size_t i = 0; i < out.size(); ++i) {
+        const F tx = std::min(std::max(x[i], F(0)), F(1));
+        const F ty = std::min(std::max(F(y[i]), F(0)), F(1));
+        const auto& c = v[i];
+        const auto fx1 = (F(1) - tx) * c[0] + tx * c[1];
+        const auto fx2 = (F(1) - tx) * c[2] + tx * c[3];
+        out[i] = (F(1) - ty) * fx1 + ty * fx2;
+    }
+}
+
+template <typename A, typename B, typename C, typename X, typename Out>
+void quadratic(const A& a, const B& b, const C& c, const X& x, Out&& out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = quadratic(a[i], b[i], c[i], x[i]);
+    }
+}
+
+template <typename V, typename X, typename Y, typename Out>
+void biQuadratic(const V& v, const X& x, const Y& y, Out&& out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = biQuadratic(v[i], x[i], y[i]);
+    }
+}
+
+template <typename V, typename X, typename Y, typename Out>
+void barycentric(const V& v, const X& x, const Y& y, Out&& out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = barycentric(v[i], x[i], y[i]);
+    }
+}
+
+/*
+ * Fixed point versions for 8 and 16 bit unsigned data that never convert to floating point.
+ * Positions are given as fractions with fractionBits bits, see fraction(), and the results are
+ * rounded to nearest and clamped to the range of the data type. The weights have fractionBits
+ * fractional bits, so for 16 bit data the quadratic results can differ from the floating point
+ * versions by a few units.
+ */
+namespace FixedPoint {
+
+constexpr int fractionBits = 16;
+constexpr int64_t one = int64_t{1} << fractionBits;
+
+// Position x in fixed point, the conversion is done once per position and not per sample
+template <typename F>
+int32_t fraction(F x) {
+    return static_cast<int32_t>(std::llround(x * static_cast<F>(one)));
+}
+
+template <typename T>
+constexpr bool isFixedPointType = std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t>;
+
+// Rounds a value with the given number of fractional bits and clamps it to the range of T
+template <typename T>
+T roundAndClamp(int64_t value, int bits) {
+    const int64_t rounded = (value + (int64_t{1} << (bits - 1))) >> bits;
+    return static_cast<T>(
+        std::min<int64_t>(std::max<int64_t>(rounded, 0), std::numeric_limits<T>::max()));
+}
+
+template <typename T, typename = std::enable_if_t<isFixedPointType<T>>>
+T linear(T a, T b, int32_t x) {
+    const int64_t t = std::min<int64_t>(std::max<int64_t>(x, 0), one);
+    return roundAndClamp<T>((one - t) * a + t * b, fractionBits);
+}
+
+template <typename T, typename = std::enable_if_t<isFixedPointType<T>>>
+T bilinear(const std::array<T, 4>& v, int32_t x, int32_t y) {
+    const int64_t tx = std::min<int64_t>(std::max<int64_t>(x, 0), one);
+    const int64_t ty = std::min<int64_t>(std::max<int64_t>(y, 0), one);
+    // The rows are kept with fractionBits extra bits to avoid rounding twice
+    const int64_t fx1 = (one - tx) * v[0] + tx * v[1];
+    const int64_t fx2 = (one - tx) * v[2] + tx * v[3];
+    return roundAndClamp<T>((one - ty) * fx1 + ty * fx2, 2 * fractionBits);
+}
+
+// The three quadratic weights of position x, rounded to fractionBits fractional bits
+inline std::array<int64_t, 3> quadraticWeights(int32_t x) {
+    const int64_t t = x;
+    const int64_t half = one / 2;
+    return {((one - t) * (one - 2 * t) + half) >> fractionBits,
+            (4 * t * (one - t) + half) >> fractionBits, (t * (2 * t - one) + half) >> fractionBits};
+}
+
+template <typename T, typename = std::enable_if_t<isFixedPointType<T>>>
+T quadratic(T a, T b, T c, int32_t x) {
+    const auto w = quadraticWeights(x);
+    return roundAndClamp<T>(w[0] * a + w[1] * b + w[2] * c, fractionBits);
+}
+
+template <typename T, typename = std::enable_if_t<isFixedPointType<T>>>
+T biQuadratic(const std::array<T, 9>& v, int32_t x, int32_t y) {
+    const auto wx = quadraticWeights(x);
+    const auto wy = quadraticWeights(y);
+    int64_t f = 0;
+    for (size_t row = 0; row < 3; ++row) {
+        const int64_t fx = wx[0] * v[3 * row] + wx[1] * v[3 * row + 1] + wx[2] * v[3 * row + 2];
+        f += wy[row] * fx;
+    }
+    return roundAndClamp<T>(f, 2 * fractionBits);
+}
+
+template <typename T, typename = std::enable_if_t<isFixedPointType<T>>>
+T barycentric(const std::array<T, 4>& v, int32_t x, int32_t y) {
+    const int64_t tx = std::min<int64_t>(std::max<int64_t>(x, 0), one);
+    const int64_t ty = std::min<int64_t>(std::max<int64_t>(y, 0), one);
+    const bool upper = tx + ty > one;
+    const int64_t f_A = upper ? v[3] : v[0];
+    const int64_t alfa = upper ? tx + ty - one : one - tx - ty;
+    const int64_t beta = upper ? one - ty : tx;
+    const int64_t gamma = upper ? one - tx : ty;
+    return roundAndClamp<T>(alfa * f_A + beta * v[1] + gamma * v[2], fractionBits);
+}
+
+}  // namespace FixedPoint
+
 }  // namespace Interpolation
 }  // namespace TNM067
 }  // namespace inviwo
@@ -0,0 +1,160 @@
+#include <modules/tnm067lab1/utils/mappedfile.h>
+#include <inviwo/core/util/exception.h>
+
+#include <utility>
+
+#ifdef WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace inviwo {
+
+namespace {
+
+// Mappings have to start at a multiple of this
+size_t mappingGranularity() {
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwAllocationGranularity);
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+}  // namespace
+
+MappedFile::View::View(void* mapping, size_t mappingSize, size_t offset, size_t size)
+    : mapping_(mapping), mappingSize_(mappingSize), offset_(offset), size_(size) {}
+
+MappedFile::View::View(View&& rhs) noexcept
+    : mapping_(std::exchange(rhs.mapping_, nullptr))
+    , mappingSize_(std::exchange(rhs.mappingSize_, 0))
+    , offset_(std::exchange(rhs.offset_, 0))
+    , size_(std::exchange(rhs.size_, 0)) {}
+
+MappedFile::View& MappedFile::View::operator=(View&& rhs) noexcept {
+    if (this != &rhs) {
+        View tmp(std::move(rhs));
+        std::swap(mapping_, tmp.mapping_);
+        std::swap(mappingSize_, tmp.mappingSize_);
+        std::swap(offset_, tmp.offset_);
+        std::swap(size_, tmp.size_);
+    }
+    return *this;
+}
+
+MappedFile::View::~View() {
+    if (!mapping_) return;
+#ifdef WIN32
+    UnmapViewOfFile(mapping_);
+#else
+    munmap(mapping_, mappingSize_);
+#endif
+}
+
+void* MappedFile::View::data() const { return static_cast<char*>(mapping_) + offset_; }
+
+size_t MappedFile::View::size() const { return size_; }
+
+MappedFile::MappedFile(const std::string& path, Mode mode, size_t size)
+    : path_(path), mode_(mode), size_(size) {
+#ifdef WIN32
+    const DWORD access = mode == Mode::Read ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+    const DWORD creation = mode == Mode::Read ? OPEN_EXISTING : CREATE_ALWAYS;
+    file_ = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr, creation,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw Exception("Could not open file: " + path, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+    if (mode == Mode::Read) {
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file_, &fileSize)) {
+            CloseHandle(file_);
+            throw Exception("Could not get the size of file: " + path,
+                            IVW_CONTEXT_CUSTOM("MappedFile"));
+        }
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+    }
+    if (size_ == 0) return;
+
+    const DWORD protect = mode == Mode::Read ? PAGE_READONLY : PAGE_READWRITE;
+    const auto size64 = static_cast<unsigned long long>(size_);
+    // Creating a writable mapping of the requested size also extends the file to that size
+    mapping_ = CreateFileMappingA(file_, nullptr, protect, static_cast<DWORD>(size64 >> 32),
+                                  static_cast<DWORD>(size64 & 0xFFFFFFFF), nullptr);
+    if (!mapping_) {
+        CloseHandle(file_);
+        throw Exception("Could not map file: " + path, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+#else
+    file_ = mode == Mode::Read ? open(path.c_str(), O_RDONLY)
+                               : open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file_ < 0) {
+        throw Exception("Could not open file: " + path, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+    if (mode == Mode::Read) {
+        struct stat info;
+        if (fstat(file_, &info) != 0) {
+            close(file_);
+            throw Exception("Could not get the size of file: " + path,
+                            IVW_CONTEXT_CUSTOM("MappedFile"));
+        }
+        size_ = static_cast<size_t>(info.st_size);
+    } else if (ftruncate(file_, static_cast<off_t>(size_)) != 0) {
+        close(file_);
+        throw Exception("Could not resize file: " + path, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef WIN32
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+#else
+    if (file_ >= 0) close(file_);
+#endif
+}
+
+size_t MappedFile::size() const { return size_; }
+
+MappedFile::View MappedFile::map(size_t offset, size_t length) const {
+    if (offset + length > size_) {
+        throw Exception("Mapped range is outside of file: " + path_,
+                        IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+    if (length == 0) return View{};
+
+    static const size_t granularity = mappingGranularity();
+    const size_t alignedOffset = offset - offset % granularity;
+    const size_t mappingSize = length + (offset - alignedOffset);
+
+#ifdef WIN32
+    const DWORD access = mode_ == Mode::Read ? FILE_MAP_READ : FILE_MAP_WRITE;
+    const auto offset64 = static_cast<unsigned long long>(alignedOffset);
+    void* mapping = MapViewOfFile(mapping_, access, static_cast<DWORD>(offset64 >> 32),
+                                  static_cast<DWORD>(offset64 & 0xFFFFFFFF), mappingSize);
+    if (!mapping) {
+        throw Exception("Could not map file: " + path_, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+#else
+    const int protect = mode_ == Mode::Read ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* mapping = mmap(nullptr, mappingSize, protect, MAP_SHARED, file_,
+                         static_cast<off_t>(alignedOffset));
+    if (mapping == MAP_FAILED) {
+        throw Exception("Could not map file: " + path_, IVW_CONTEXT_CUSTOM("MappedFile"));
+    }
+#endif
+    return View(mapping, mappingSize, offset - alignedOffset, length);
+}
+
+}  // namespace inviwo
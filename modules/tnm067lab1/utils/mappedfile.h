@@ -0,0 +1,76 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <cstddef>
+#include <string>
+
+namespace inviwo {
+
+/**
+ * \class MappedFile
+ * \brief A file on disk of which byte ranges can be mapped into memory
+ *
+ * Only the mapped ranges occupy address space, so files larger than the available memory can be
+ * processed piece by piece. Throws an inviwo::Exception if the file can not be opened or mapped.
+ */
+class IVW_MODULE_TNM067LAB1_API MappedFile {
+public:
+    enum class Mode { Read, Write };
+
+    /**
+     * A mapped byte range, unmapped when destroyed. Writes to a range of a file opened with
+     * Mode::Write end up in the file.
+     */
+    class IVW_MODULE_TNM067LAB1_API View {
+    public:
+        View() = default;
+        View(const View&) = delete;
+        View(View&& rhs) noexcept;
+        View& operator=(const View&) = delete;
+        View& operator=(View&& rhs) noexcept;
+        ~View();
+
+        void* data() const;
+        size_t size() const;
+
+    private:
+        friend class MappedFile;
+        View(void* mapping, size_t mappingSize, size_t offset, size_t size);
+
+        void* mapping_ = nullptr;  // page aligned start of the mapping
+        size_t mappingSize_ = 0;
+        size_t offset_ = 0;  // offset of the requested range within the mapping
+        size_t size_ = 0;
+    };
+
+    /**
+     * Opens the file at path. With Mode::Write the file is created, or truncated, to the given
+     * size, with Mode::Read the size is taken from the file.
+     */
+    MappedFile(const std::string& path, Mode mode, size_t size = 0);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    size_t size() const;
+
+    /**
+     * Maps the bytes [offset, offset + length) of the file. The range does not have to be page
+     * aligned.
+     */
+    View map(size_t offset, size_t length) const;
+
+private:
+    std::string path_;
+    Mode mode_;
+    size_t size_ = 0;
+#ifdef WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int file_ = -1;
+#endif
+};
+
+}  // namespace inviwo
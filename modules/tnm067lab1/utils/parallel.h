@@ -0,0 +1,60 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/common/inviwoapplication.h>
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * Splits the indices 0 to count - 1 into consecutive ranges and calls callback(begin, end) for
+ * each range on the thread pool, then waits for all of them. Without a given number of jobs four
+ * ranges per pool thread are used, as in util::forEachPixelParallel. Scratch memory needed by the
+ * callback can be allocated once per range. Runs on the calling thread if the pool is empty.
+ * Exceptions thrown by the callback are rethrown once all ranges are done.
+ */
+template <typename Callback>
+void forEachRangeParallel(size_t count, Callback callback, size_t jobs = 0) {
+    if (count == 0) return;
+    if (jobs == 0) {
+        jobs = 4 * InviwoApplication::getPtr()->getPoolSize();
+        if (jobs == 0) {
+            callback(size_t{0}, count);
+            return;
+        }
+    }
+    jobs = std::min(jobs, count);
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(jobs);
+    for (size_t job = 0; job < jobs; ++job) {
+        const size_t begin = job * count / jobs;
+        const size_t end = (job + 1) * count / jobs;
+        futures.push_back(dispatchPool([&callback, begin, end]() { callback(begin, end); }));
+    }
+    // The callback is shared by all jobs, so wait for every job before an exception can leave
+    for (const auto& future : futures) future.wait();
+    for (auto& future : futures) future.get();
+}
+
+/**
+ * Calls callback(i) for the indices 0 to count - 1 on the thread pool, see forEachRangeParallel.
+ */
+template <typename Callback>
+void forEachIndexParallel(size_t count, Callback callback, size_t jobs = 0) {
+    forEachRangeParallel(
+        count,
+        [&callback](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) callback(i);
+        },
+        jobs);
+}
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -1,11 +1,63 @@
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/util/assertion.h>
+
+#include <algorithm>
 
 namespace inviwo {
 
-void ScalarToColorMapping::clearColors() { baseColors_.clear(); }
-void ScalarToColorMapping::addBaseColors(vec4 color) { baseColors_.push_back(color); }
+namespace {
+
+// Clamps t to [0, 1]. NaN, a common no-data value in float images, is mapped to 0 since it
+// fails the comparison inside std::max
+float clampNormalized(float t) { return std::min(std::max(0.0f, t), 1.0f); }
+
+}  // namespace
+
+void ScalarToColorMapping::clearColors() {
+    baseColors_.clear();
+    updateLookupTable();
+}
+void ScalarToColorMapping::addBaseColors(vec4 color) {
+    baseColors_.push_back(color);
+    updateLookupTable();
+}
 
 vec4 ScalarToColorMapping::sample(float t) const {
+    if (lookupTableSize_ == 0) return interpolate(t);
+
+    const float maxIndex = static_cast<float>(lookupTable_.size() - 1);
+    const float i = clampNormalized(t) * maxIndex + 0.5f;
+    return lookupTable_[static_cast<size_t>(i)];
+}
+
+void ScalarToColorMapping::sampleBatch(util::span<const float> t, util::span<vec4> colors) const {
+    IVW_ASSERT(colors.size() >= t.size(), "Output span is too small");
+
+    if (lookupTableSize_ == 0) {
+        std::transform(t.begin(), t.end(), colors.begin(), [&](float v) { return interpolate(v); });
+        return;
+    }
+
+    // Keep the loop free of branches so that the index computation and the gather can be
+    // vectorized by the compiler
+    const vec4* table = lookupTable_.data();
+    const float maxIndex = static_cast<float>(lookupTable_.size() - 1);
+    const size_t count = t.size();
+    for (size_t i = 0; i < count; ++i) {
+        colors[i] = table[static_cast<size_t>(clampNormalized(t[i]) * maxIndex + 0.5f)];
+    }
+}
+
+void ScalarToColorMapping::setLookupTableSize(size_t size) {
+    if (size == 1) size = 2;  // need at least the two end points
+    if (lookupTableSize_ == size) return;
+    lookupTableSize_ = size;
+    updateLookupTable();
+}
+
+size_t ScalarToColorMapping::getLookupTableSize() const { return lookupTableSize_; }
+
+vec4 ScalarToColorMapping::interpolate(float t) const {
     if (baseColors_.size() == 0) return vec4(t);
     if (baseColors_.size() == 1) return vec4(baseColors_[0]);
 
@@ -13,7 +65,7 @@ vec4 ScalarToColorMapping::sample(float t) const {
     // Interpolate colors in baseColors_
     // return the right values
 
-    if (t <= 0) return vec4(baseColors_.front());
+    if (!(t > 0)) return vec4(baseColors_.front());  // also catches NaN
     if (t >= 1) return vec4(baseColors_.back());
 
     float interpolatedPoint = t * (baseColors_.size() - 1.f);
@@ -27,4 +79,14 @@ vec4 ScalarToColorMapping::sample(float t) const {
     return finalColor;
 }
 
+void ScalarToColorMapping::updateLookupTable() {
+    lookupTable_.resize(lookupTableSize_);
+    if (lookupTableSize_ == 0) return;
+
+    const float maxIndex = static_cast<float>(lookupTableSize_ - 1);
+    for (size_t i = 0; i < lookupTableSize_; ++i) {
+        lookupTable_[i] = interpolate(static_cast<float>(i) / maxIndex);
+    }
+}
+
 }  // namespace inviwo
@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <inviwo/core/util/glmvec.h>
+#include <inviwo/core/util/span.h>
 
 // Change this to one to enable the Unit tests for ScalarToColorMapping
 #define ENABLE_COLORMAPPING_UNITTEST 0
@@ -15,6 +16,10 @@ namespace inviwo {
  * \brief Scalar to color mapping
  * Color are interpolated from the baseColors_ and stored
  * in interpolatedColors_
+ *
+ * Optionally the mapping can be baked into a lookup table of fixed size, see
+ * setLookupTableSize(). The table is rebuilt whenever the base colors change, sample() and
+ * sampleBatch() then only perform a clamped table lookup.
  */
 class IVW_MODULE_TNM067LAB1_API ScalarToColorMapping {
 public:
@@ -23,8 +28,27 @@ public:
     void clearColors();
     vec4 sample(float t) const;
 
+    /**
+     * Maps all values in \p t to colors in \p colors, \p colors must be at least as large as
+     * \p t. Equivalent to calling sample() for every element, but without the per element
+     * branching when a lookup table is used.
+     */
+    void sampleBatch(util::span<const float> t, util::span<vec4> colors) const;
+
+    /**
+     * Bake the mapping into a lookup table with \p size entries. A size of zero disables the
+     * lookup table and makes sample() interpolate the base colors directly.
+     */
+    void setLookupTableSize(size_t size);
+    size_t getLookupTableSize() const;
+
 private:
+    vec4 interpolate(float t) const;
+    void updateLookupTable();
+
     std::vector<vec4> baseColors_;  // base colors to be interpolated
+    size_t lookupTableSize_ = 0;
+    std::vector<vec4> lookupTable_;  // baked colors, empty if no lookup table is used
 };
 
 }  // namespace inviwo
@@ -0,0 +1,149 @@
+#include <modules/tnm067lab1/utils/tracer.h>
+#include <inviwo/core/util/exception.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace inviwo {
+
+namespace {
+
+// Small sequential ids are easier to read in the trace viewer than native thread ids
+size_t threadId() {
+    static std::atomic<size_t> nextId{0};
+    thread_local const size_t id = nextId++;
+    return id;
+}
+
+int64_t microseconds(Tracer::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+void writeEscaped(std::ostream& os, const char* str) {
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') os << '\\';
+        os << *str;
+    }
+}
+
+}  // namespace
+
+Tracer& Tracer::get() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() : epoch_(Clock::now()) {
+    if (const char* path = std::getenv("TNM067_TRACE"); path && *path) {
+        exitPath_ = path;
+        enabled_ = true;
+    }
+}
+
+Tracer::~Tracer() {
+    if (exitPath_.empty()) return;
+    try {
+        writeChromeTrace(exitPath_);
+    } catch (const Exception&) {
+        // Nowhere left to report the error during shutdown
+    }
+}
+
+void Tracer::setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+void Tracer::addDuration(const char* name, Clock::time_point start, Clock::time_point end) {
+    const Event event{name, 'X', microseconds(start - epoch_), microseconds(end - start), 0,
+                      threadId()};
+    std::scoped_lock lock(mutex_);
+    push(event);
+}
+
+void Tracer::addCounter(const char* name, int64_t value) {
+    if (!isEnabled()) return;
+    const Event event{name, 'C', microseconds(Clock::now() - epoch_), 0, value, threadId()};
+    std::scoped_lock lock(mutex_);
+    push(event);
+}
+
+void Tracer::push(const Event& event) {
+    if (maxEvents_ == 0) {
+        ++droppedEvents_;
+        return;
+    }
+    if (events_.size() == maxEvents_) {
+        events_.pop_front();
+        ++droppedEvents_;
+    }
+    events_.push_back(event);
+}
+
+void Tracer::clear() {
+    std::scoped_lock lock(mutex_);
+    events_.clear();
+    droppedEvents_ = 0;
+}
+
+size_t Tracer::getMaxEvents() const {
+    std::scoped_lock lock(mutex_);
+    return maxEvents_;
+}
+
+void Tracer::setMaxEvents(size_t maxEvents) {
+    std::scoped_lock lock(mutex_);
+    maxEvents_ = maxEvents;
+    while (events_.size() > maxEvents_) {
+        events_.pop_front();
+        ++droppedEvents_;
+    }
+}
+
+size_t Tracer::getNumEvents() const {
+    std::scoped_lock lock(mutex_);
+    return events_.size();
+}
+
+std::string Tracer::toChromeTrace() const {
+    std::stringstream ss;
+    ss << "{\"traceEvents\":[";
+    std::scoped_lock lock(mutex_);
+    bool first = true;
+    for (const auto& e : events_) {
+        ss << (first ? "\n" : ",\n") << "{\"name\":\"";
+        first = false;
+        writeEscaped(ss, e.name);
+        ss << "\",\"cat\":\"tnm067\",\"ph\":\"" << e.phase << "\",\"ts\":" << e.timestamp
+           << ",\"pid\":1,\"tid\":" << e.thread;
+        if (e.phase == 'X') {
+            ss << ",\"dur\":" << e.duration;
+        } else {
+            ss << ",\"args\":{\"value\":" << e.value << "}";
+        }
+        ss << "}";
+    }
+    ss << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << droppedEvents_
+       << "}}\n";
+    return ss.str();
+}
+
+void Tracer::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        throw Exception("Could not write trace to " + path, IVW_CONTEXT_CUSTOM("Tracer"));
+    }
+    file << toChromeTrace();
+}
+
+ScopedTimer::ScopedTimer(const char* name) : name_(name), enabled_(Tracer::get().isEnabled()) {
+    if (enabled_) start_ = Tracer::Clock::now();
+}
+
+ScopedTimer::~ScopedTimer() { stop(); }
+
+void ScopedTimer::stop() {
+    if (!enabled_) return;
+    Tracer::get().addDuration(name_, start_, Tracer::Clock::now());
+    enabled_ = false;
+}
+
+}  // namespace inviwo
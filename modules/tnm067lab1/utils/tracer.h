@@ -0,0 +1,99 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace inviwo {
+
+/**
+ * \class Tracer
+ * \brief Collects timings and counters of the TNM067 processors as a Chrome trace
+ *
+ * Tracing is disabled by default and then only costs a relaxed atomic load per scope. It can be
+ * switched on at runtime with setEnabled(), e.g. from the TraceRecorder processor, or at startup by
+ * setting the environment variable TNM067_TRACE to a file path, in which case the trace is also
+ * written to that file on exit. The trace can be opened in chrome://tracing or Perfetto.
+ *
+ * Event names are not copied and have to outlive the tracer, i.e. be string literals. At most
+ * getMaxEvents() events are kept. When the buffer is full the oldest events are dropped,
+ * so the trace always covers the most recent work.
+ */
+class IVW_MODULE_TNM067LAB1_API Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Tracer& get();
+
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    // Adds a duration event on the calling thread
+    void addDuration(const char* name, Clock::time_point start, Clock::time_point end);
+    // Adds a counter event with the current time, ignored if tracing is disabled
+    void addCounter(const char* name, int64_t value);
+    void clear();
+
+    size_t getMaxEvents() const;
+    // Drops the oldest events if more than maxEvents are recorded
+    void setMaxEvents(size_t maxEvents);
+    size_t getNumEvents() const;
+
+    // The recorded events in the Chrome trace event JSON format
+    std::string toChromeTrace() const;
+    // Throws an inviwo::Exception if the file can not be written
+    void writeChromeTrace(const std::string& path) const;
+
+private:
+    Tracer();
+    ~Tracer();
+
+    static constexpr size_t defaultMaxEvents = 1'000'000;
+
+    struct Event {
+        const char* name;
+        char phase;
+        int64_t timestamp;  // in microseconds since the creation of the tracer
+        int64_t duration;
+        int64_t value;
+        size_t thread;
+    };
+
+    std::atomic<bool> enabled_{false};
+    Clock::time_point epoch_;
+    std::string exitPath_;
+    mutable std::mutex mutex_;
+    std::deque<Event> events_;
+    size_t maxEvents_ = defaultMaxEvents;
+    size_t droppedEvents_ = 0;
+
+    // Appends an event, mutex_ has to be locked
+    void push(const Event& event);
+};
+
+/**
+ * \class ScopedTimer
+ * \brief Records the lifetime of the object as a duration event, if tracing is enabled
+ */
+class IVW_MODULE_TNM067LAB1_API ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name);
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer();
+
+    // Ends the event before the end of the scope
+    void stop();
+
+private:
+    const char* name_;
+    bool enabled_;
+    Tracer::Clock::time_point start_;
+};
+
+}  // namespace inviwo
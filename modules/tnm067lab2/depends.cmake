@@ -0,0 +1,8 @@
+#--------------------------------------------------------------------
+# Dependencies for TNM067Lab2 module
+# List modules on the format "Inviwo<ModuleName>Module"
+#--------------------------------------------------------------------
+# TNM067Lab1 provides the Tracer used by the lab2 processors
+set(dependencies
+    InviwoTNM067Lab1Module
+)
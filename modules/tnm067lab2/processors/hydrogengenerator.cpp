@@ -1,13 +1,72 @@
 #include <modules/tnm067lab2/processors/hydrogengenerator.h>
 #include <inviwo/core/datastructures/volume/volume.h>
 #include <inviwo/core/util/volumeramutils.h>
-#include <modules/base/algorithm/dataminmax.h>
+#include <modules/tnm067lab1/utils/tracer.h>
+#include <modules/tnm067lab2/utils/volumegeneration.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/datastructures/volume/volumeram.h>
-#include <modules/base/algorithm/dataminmax.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 namespace inviwo {
 
+namespace {
+
+const double normalization = 1.0 / (81.0 * std::sqrt(6.0 * M_PI));
+
+/*
+ * exp(x) for x <= 0 in single precision, written without branches or calls so that loops over
+ * it can be vectorized. exp(x) = 2^n * 2^f with n = floor(x * log2(e)), 2^f is approximated by a
+ * degree 5 minimax polynomial on [0, 1) and 2^n is put together directly in the exponent bits.
+ */
+inline float fastExp(float x) {
+    const float t = glm::max(x * 1.44269504f, -126.0f);
+    const float n = std::floor(t);
+    const float f = t - n;
+    const float p =
+        0.999999940f +
+        f * (0.693153083f +
+             f * (0.240153617f + f * (0.0558263180f + f * (0.00898933970f + f * 0.00187757667f))));
+    const std::int32_t bits = (static_cast<std::int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+/*
+ * Evaluates one row of the 3d_z^2 density along x. In Cartesian form the angular part is
+ * r^2 * (3 cos^2(theta) - 1) = 3 z^2 - r^2, so no trigonometric functions are needed.
+ */
+void evalRowDouble(const float* xs, size_t count, float y, float z, float* out) {
+    const double z2 = static_cast<double>(z) * z;
+    const double yz2 = static_cast<double>(y) * y + z2;
+    for (size_t i = 0; i < count; ++i) {
+        const double x = xs[i];
+        const double r2 = x * x + yz2;
+        const double psi = normalization * std::exp(-std::sqrt(r2) / 3.0) * (3.0 * z2 - r2);
+        out[i] = static_cast<float>(psi * psi);
+    }
+}
+
+void evalRowFast(const float* xs, size_t count, float y, float z, float* out) {
+    const float z2 = z * z;
+    const float yz2 = y * y + z2;
+    const float norm = static_cast<float>(normalization);
+    for (size_t i = 0; i < count; ++i) {
+        const float x = xs[i];
+        const float r2 = x * x + yz2;
+        const float psi = norm * fastExp(-std::sqrt(r2) * (1.0f / 3.0f)) * (3.0f * z2 - r2);
+        out[i] = psi * psi;
+    }
+}
+
+}  // namespace
+
 const ProcessorInfo HydrogenGenerator::processorInfo_{
     "org.inviwo.HydrogenGenerator",  // Class identifier
     "Hydrogen Generator",            // Display name
@@ -19,25 +78,73 @@ const ProcessorInfo HydrogenGenerator::processorInfo_{
 const ProcessorInfo HydrogenGenerator::getProcessorInfo() const { return processorInfo_; }
 
 HydrogenGenerator::HydrogenGenerator()
-    : Processor(), volume_("volume"), size_("size_", "Volume Size", 16, 4, 256) {
+    : Processor()
+    , volume_("volume")
+    , size_("size_", "Volume Size", 16, 4, 1024)
+    , precision_("precision", "Precision",
+                 {{"double", "Double", Precision::Double}, {"fast", "Fast", Precision::Fast}}, 0) {
     addPort(volume_);
     addProperty(size_);
+    addProperty(precision_);
 }
 
 void HydrogenGenerator::process() {
+    ScopedTimer timer("HydrogenGenerator::process");
     auto vol = std::make_shared<Volume>(size3_t(size_), DataFloat32::get());
 
     auto ram = vol->getEditableRepresentation<VolumeRAM>();
     auto data = static_cast<float*>(ram->getData());
-    util::IndexMapper3D index(ram->getDimensions());
-
-    util::forEachVoxel(*ram, [&](const size3_t& pos) {
-        vec3 cartesian = idTOCartesian(pos);
-        data[index(pos)] = static_cast<float>(eval(cartesian));
-    });
-
-    auto minMax = util::volumeMinMax(ram);
-    vol->dataMap_.dataRange = vol->dataMap_.valueRange = dvec2(minMax.first.x, minMax.second.x);
+    const size3_t dims = ram->getDimensions();
+    util::IndexMapper3D index(dims);
+
+    // The grid coordinates along each axis, the volume is a cube so one table serves all axes
+    const size_t n = dims.x;
+    std::vector<float> coords(n);
+    for (size_t i = 0; i < n; ++i) coords[i] = idTOCartesian(size3_t(i)).x;
+
+    /*
+     * The grid is centered on the origin and the density only depends on x^2 + y^2 and z^2, so it
+     * is mirror symmetric in all three axes and symmetric under swapping x and y. Only the part of
+     * the positive octant with x >= y is evaluated, everything else is copied. Voxel i and
+     * n - 1 - i get the same value, the mirrored voxels use the coordinate of the evaluated one.
+     */
+    const size_t half = n / 2;  // First index of the upper half
+    const auto mirror = [n](size_t i) { return n - 1 - i; };
+    std::atomic<int64_t> evaluated{0};
+    const auto range = [&]() {
+        ScopedTimer evalTimer("HydrogenGenerator::eval");
+        const auto evalRow = precision_.get() == Precision::Fast ? evalRowFast : evalRowDouble;
+        // One job per z slice of the upper half. Every value of the volume is an evaluated one, so
+        // the range of the evaluated rows is the range of the volume.
+        auto generateSlice = [&](size_t job, util::ValueRange<float>& sliceRange) {
+            const size_t z = half + job;
+            int64_t count = 0;
+            for (size_t y = half; y < n; ++y) {
+                float* row = data + index(size3_t(0, y, z));
+                evalRow(coords.data() + y, n - y, coords[y], coords[z], row + y);
+                sliceRange.add(row + y, n - y);
+                count += n - y;
+                // The rows above have already been evaluated from x = y on
+                for (size_t x = half; x < y; ++x) row[x] = data[index(size3_t(y, x, z))];
+                for (size_t x = half; x < n; ++x) row[mirror(x)] = row[x];
+            }
+            for (size_t y = half; y < n; ++y) {
+                std::copy_n(data + index(size3_t(0, y, z)), n,
+                            data + index(size3_t(0, mirror(y), z)));
+            }
+            if (mirror(z) != z) {
+                std::copy_n(data + index(size3_t(0, 0, z)), n * n,
+                            data + index(size3_t(0, 0, mirror(z))));
+            }
+            evaluated += count;
+        };
+        return util::generateWithStatistics<float>(n - half, generateSlice);
+    }();
+    Tracer::get().addCounter("HydrogenGenerator voxels",
+                             static_cast<int64_t>(dims.x * dims.y * dims.z));
+    Tracer::get().addCounter("HydrogenGenerator evaluated voxels", evaluated);
+
+    vol->dataMap_.dataRange = vol->dataMap_.valueRange = range.toDvec2();
 
     volume_.setData(vol);
 }
@@ -55,18 +162,13 @@ vec3 HydrogenGenerator::cartesianToSphereical(vec3 cartesian) {
 }
 
 double HydrogenGenerator::eval(vec3 cartesian) {
+    // r^2 * (3 cos^2(theta) - 1) with cos(theta) = z / r
+    const double z2{(double)cartesian.z * cartesian.z};
+    const double r2{glm::dot(dvec3(cartesian), dvec3(cartesian))};
 
-    vec3 spherical = cartesianToSphereical(cartesian);
-
-    const double term1{1.0/(81.0*sqrt(6.0*M_PI))};
-
-    const double term3{(double)spherical.x * spherical.x};
-
-    const double term4{exp(-spherical.x / 3.0)};
+    const double psi{normalization * exp(-sqrt(r2) / 3.0) * (3.0 * z2 - r2)};
 
-    const double term5{3.0 * pow(cos(spherical.y), 2.0) - 1.0};
-    
-    return pow(term1 * term3 * term4* term5, 2.0);
+    return psi * psi;
 }
 
 vec3 HydrogenGenerator::idTOCartesian(size3_t pos) {
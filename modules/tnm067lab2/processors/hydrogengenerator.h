@@ -3,6 +3,7 @@
 #include <modules/tnm067lab2/tnm067lab2moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/volumeport.h>
 
@@ -10,6 +11,13 @@ namespace inviwo {
 
 class IVW_MODULE_TNM067LAB2_API HydrogenGenerator : public Processor {
 public:
+    /**
+     * Double evaluates the density like eval(). Fast evaluates it in single precision with a
+     * polynomial approximation of exp, with a relative error below 2e-6, which lets the compiler
+     * vectorize the rows.
+     */
+    enum class Precision { Double, Fast };
+
     HydrogenGenerator();
     virtual ~HydrogenGenerator() = default;
 
@@ -27,6 +35,7 @@ private:
     VolumeOutport volume_;
 
     IntSizeTProperty size_;
+    TemplateOptionProperty<Precision> precision_;
 };
 
 }  // namespace inviwo
@@ -1,13 +1,63 @@
 #include <modules/tnm067lab2/processors/marchingtetrahedra.h>
-#include <inviwo/core/datastructures/geometry/basicmesh.h>
+#include <modules/tnm067lab2/utils/tetrahedracases.h>
 #include <inviwo/core/datastructures/volume/volumeram.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/util/assertion.h>
 #include <inviwo/core/network/networklock.h>
+#include <modules/tnm067lab1/utils/parallel.h>
+#include <modules/tnm067lab1/utils/tracer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
 
 namespace inviwo {
 
-size_t MarchingTetrahedra::HashFunc::max = 1;
+namespace {
+
+// The edge length, in cells, of the blocks of the min/max index and the thickness of the z-slabs
+constexpr size_t blockSize = 8;
+
+/*
+ * Computes the smallest and largest value of the voxels of every block of cells, including the
+ * voxels that a block shares with its neighbours. The values are converted like in extractSlab.
+ */
+template <typename T>
+void computeBlockRanges(const T* data, size3_t dims, size3_t blocks, std::vector<vec2>& ranges) {
+    const util::IndexMapper3D index(dims);
+    const util::IndexMapper3D blockIndex(blocks);
+    ranges.resize(blocks.x * blocks.y * blocks.z);
+
+    // One job per z-layer of blocks
+    util::forEachIndexParallel(blocks.z, [&](size_t bz) {
+        for (size_t by = 0; by < blocks.y; ++by) {
+            for (size_t bx = 0; bx < blocks.x; ++bx) {
+                const size3_t block(bx, by, bz);
+                const size3_t begin = block * blockSize;
+                const size3_t end = glm::min(begin + size3_t(blockSize + 1), dims);
+
+                vec2 range(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+                for (size_t z = begin.z; z < end.z; ++z) {
+                    for (size_t y = begin.y; y < end.y; ++y) {
+                        const T* row = data + index(size3_t(0, y, z));
+                        for (size_t x = begin.x; x < end.x; ++x) {
+                            const float value = static_cast<float>(static_cast<double>(row[x]));
+                            range.x = std::min(range.x, value);
+                            range.y = std::max(range.y, value);
+                        }
+                    }
+                }
+                ranges[blockIndex(block)] = range;
+            }
+        }
+    });
+}
+
+}  // namespace
 
 const ProcessorInfo MarchingTetrahedra::processorInfo_{
     "org.inviwo.MarchingTetrahedra",  // Class identifier
@@ -32,6 +82,7 @@ MarchingTetrahedra::MarchingTetrahedra()
     isoValue_.setSerializationMode(PropertySerializationMode::All);
 
     volume_.onChange([&]() {
+        blockRanges_ = BlockRanges{};
         if (!volume_.hasData()) {
             return;
         }
@@ -55,147 +106,149 @@ size_t MarchingTetrahedra::calcTriangleVert(MeshHelper& mesh, const MarchingTetr
     return mesh.addVertex(v, voxel0.index, voxel1.index);
 }
 
-void MarchingTetrahedra::calcTriangle(MarchingTetrahedra::MeshHelper &mesh, const float& iso, 
-	const MarchingTetrahedra::Voxel& vox0, const MarchingTetrahedra::Voxel& vox1,
-	const MarchingTetrahedra::Voxel& vox2, const MarchingTetrahedra::Voxel& vox3, 
-	const MarchingTetrahedra::Voxel& vox4, const MarchingTetrahedra::Voxel& vox5) {
-
-        size_t v0 = calcTriangleVert(mesh, vox0, vox1, iso);
-        size_t v1 = calcTriangleVert(mesh, vox2, vox3, iso);
-        size_t v2 = calcTriangleVert(mesh, vox4, vox5, iso);
-
-        mesh.addTriangle(v0, v1, v2);
-}
-
 /*----------------------------------------------------------------*/
 
 void MarchingTetrahedra::process() {
+    ScopedTimer timer("MarchingTetrahedra::process");
     auto volume = volume_.getData()->getRepresentation<VolumeRAM>();
-    MeshHelper mesh(volume_.getData());
-
     const auto& dims = volume->getDimensions();
-    //MarchingTetrahedra::HashFunc::max = dims.x * dims.y * dims.z;
-
+    MeshHelper mesh(dims);
     const float iso = isoValue_.get();
 
-    util::IndexMapper3D index(dims);
-
-    const static size_t tetrahedraIds[6][4] = {{0, 1, 2, 5}, {1, 3, 2, 5}, {3, 2, 5, 7},
-                                               {0, 2, 4, 5}, {6, 4, 2, 5}, {6, 7, 5, 2}};
-
-    size3_t max{dims - size3_t{1}};
-    size3_t pos{};
-    for (pos.z = 0; pos.z < max.x; ++pos.z) {
-        for (pos.y = 0; pos.y < max.y; ++pos.y) {
-            for (pos.x = 0; pos.x < max.x; ++pos.x) {
-                // Step 1: create current cell
-                // Use volume->getAsDouble to query values from the volume
-                // Spatial position should be between 0 and 1
-                // The voxel index should be the 1D-index for the voxel
-
-                Cell c;
-                int voxelIndex{0};
-                for (int z = 0; z < 2; ++z) {
-                    for (int y = 0; y < 2; ++y) {
-                        for (int x = 0; x < 2; ++x) {
-                            // pos == (0, 0, 0)
-
-                            size3_t current{x + pos.x, y + pos.y, z + pos.z};
-                            //vec3 voxelPos = static_cast<vec3>(current) / static_cast<vec3>(max);
-                            vec3 voxelPos{(pos.x + x) / (dims.x - 1.0), (pos.y + y) / (dims.y - 1.0), (pos.z + z) / (dims.z - 1.0)};
-                 
-                            c.voxels[voxelIndex++] = { voxelPos, static_cast<float>(volume->getAsDouble(current)), index(current)};
-                        }
-                    }
-                }
-                
-                // Step 2: Subdivide cell into tetrahedra (hint: use tetrahedraIds)
-                std::vector<Tetrahedra> tetrahedras;
-
-                for (size_t s{0}; s < 6; ++s) {
-                    Tetrahedra tetra;
-                    for (size_t t{0}; t < 4; ++t) {
-                        tetra.voxels[t] = c.voxels[tetrahedraIds[s][t]];
-                    }
-
-                    tetrahedras.push_back(tetra);
-                }
-
-                for (const Tetrahedra& tetrahedra : tetrahedras) {
-                    // Step three: Calculate for tetra case index
-                    int caseId = 0;
-
-                    const auto& voxel0 = tetrahedra.voxels[0];
-                    const auto& voxel1 = tetrahedra.voxels[1];
-                    const auto& voxel2 = tetrahedra.voxels[2];
-                    const auto& voxel3 = tetrahedra.voxels[3];
-
-                    if (voxel0.value < iso) caseId |= 1;
-                    if (voxel1.value < iso) caseId |= 2;
-                    if (voxel2.value < iso) caseId |= 4;
-                    if (voxel3.value < iso) caseId |= 8;
-
-                    // std::bitset<4> caseId(caseId);
-                    size_t v0{}, v1{}, v2{}, v3{}, v4{}, v5{};
+    /*
+     * The cells are split into z-slabs of a fixed thickness that are extracted in parallel, each
+     * into its own MeshHelper. Appending the slabs in order then gives the same mesh as a serial
+     * extraction for any number of threads, only the normal sums of the vertices on the slab
+     * boundaries are added up in a different order. A slab is one layer of blocks thick.
+     */
+    const size_t slabThickness = blockSize;
+    const size_t numCells = dims.z - 1;
+    const size_t numSlabs = (numCells + slabThickness - 1) / slabThickness;
+
+    std::vector<MeshHelper> slabs;
+    slabs.reserve(numSlabs);
+    for (size_t i = 0; i < numSlabs; ++i) slabs.emplace_back(dims);
+
+    // The spatial positions, between 0 and 1, of the voxels along each axis
+    std::array<std::vector<float>, 3> positions;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        positions[axis].resize(dims[axis]);
+        for (size_t i = 0; i < dims[axis]; ++i) {
+            positions[axis][i] = static_cast<float>(i / (dims[axis] - 1.0));
+        }
+    }
 
-                    if (caseId == 1 || caseId == 14) {
+    std::atomic<size_t> cellsVisited{0};
+    volume->dispatch<void, dispatching::filter::Scalars>([&](const auto ram) {
+        const auto data = ram->getDataTyped();
 
-                        if (caseId == 1) {
-                            calcTriangle(mesh, iso, voxel0, voxel1, voxel0, voxel3, voxel0, voxel2);
-                        } else {
-                            calcTriangle(mesh, iso, voxel0, voxel1, voxel0, voxel2, voxel0, voxel3);
-                        }
-            
-                    } else if (caseId == 2 || caseId == 13) {
+        if (blockRanges_.ranges.empty()) {
+            ScopedTimer indexTimer("MarchingTetrahedra block index");
+            blockRanges_.blocks = (dims - size3_t(1) + size3_t(blockSize - 1)) / blockSize;
+            computeBlockRanges(data, dims, blockRanges_.blocks, blockRanges_.ranges);
+        }
 
-                        if (caseId == 2) {
-                            calcTriangle(mesh, iso, voxel1, voxel0, voxel1, voxel2, voxel1, voxel3);
-                        } else {
-                            calcTriangle(mesh, iso, voxel1, voxel0, voxel1, voxel3, voxel1, voxel2);
-                        }
+        ScopedTimer cellTimer("MarchingTetrahedra cells");
+        util::forEachIndexParallel(numSlabs, [&](size_t slab) {
+            const size_t zBegin = slab * slabThickness;
+            const size_t zEnd = std::min(zBegin + slabThickness, numCells);
+            cellsVisited += extractSlab(data, dims, positions, zBegin, zEnd, iso, slabs[slab]);
+        });
+    });
 
-                    } else if (caseId == 3 || caseId == 12) {
+    {
+        ScopedTimer stitchTimer("MarchingTetrahedra stitching");
+        const size_t planeSize = dims.x * dims.y;
+        for (size_t i = 0; i < numSlabs; ++i) {
+            const size_t zBegin = i * slabThickness;
+            const size_t zEnd = std::min(zBegin + slabThickness, numCells);
+            mesh.append(std::move(slabs[i]), size2_t(zBegin * planeSize, (zBegin + 1) * planeSize),
+                        size2_t(zEnd * planeSize, (zEnd + 1) * planeSize));
+        }
+    }
 
-                        if (caseId == 3) {
-                            calcTriangle(mesh, iso, voxel1, voxel2, voxel1, voxel3, voxel0, voxel3);
-                            calcTriangle(mesh, iso, voxel1, voxel2, voxel0, voxel3, voxel0, voxel2);
-                        } else {
-                            calcTriangle(mesh, iso, voxel1, voxel2, voxel0, voxel3, voxel1, voxel3);
-                            calcTriangle(mesh, iso, voxel1, voxel2, voxel0, voxel2, voxel0, voxel3);
-                        }
-                            
-                    } else if (caseId == 4 || caseId == 11) {
+    const auto& statistics = mesh.getStatistics();
+    auto& tracer = Tracer::get();
+    tracer.addCounter("MarchingTetrahedra cells visited", static_cast<int64_t>(cellsVisited));
+    tracer.addCounter("MarchingTetrahedra triangles", static_cast<int64_t>(statistics.triangles));
+    tracer.addCounter("MarchingTetrahedra edge cache hits",
+                      static_cast<int64_t>(statistics.edgeCacheHits));
+    tracer.addCounter("MarchingTetrahedra edge cache misses",
+                      static_cast<int64_t>(statistics.edgeCacheMisses));
 
-                        if (caseId == 4) {
-                            calcTriangle(mesh, iso, voxel2, voxel3, voxel2, voxel1, voxel2, voxel0);
-                        } else {
-                            calcTriangle(mesh, iso, voxel2, voxel3, voxel2, voxel0, voxel2, voxel1);
-                        }
+    mesh_.setData(mesh.toMesh(*volume_.getData()));
+}
 
-                    } else if (caseId == 5 || caseId == 10) {
+template <typename T>
+size_t MarchingTetrahedra::extractSlab(const T* data, size3_t dims,
+                                       const std::array<std::vector<float>, 3>& positions,
+                                       size_t zBegin, size_t zEnd, float iso, MeshHelper& mesh) {
+    const util::IndexMapper3D index(dims);
+
+    // The same conversion as VolumeRAM::getAsDouble followed by a cast to float
+    const auto value = [](const T& v) { return static_cast<float>(static_cast<double>(v)); };
+
+    const util::IndexMapper3D blockIndex(blockRanges_.blocks);
+    const size_t bz = zBegin / blockSize;
+
+    size_t cellsVisited = 0;
+    for (size_t z = zBegin; z < zEnd; ++z) {
+        for (size_t y = 0; y + 1 < dims.y; ++y) {
+            // The first voxel of the four rows of voxels that the cells in this row touch
+            const std::array<size_t, 4> rows = {index(size3_t(0, y, z)),
+                                                index(size3_t(0, y + 1, z)),
+                                                index(size3_t(0, y, z + 1)),
+                                                index(size3_t(0, y + 1, z + 1))};
+            const size_t by = y / blockSize;
+            for (size_t bx = 0; bx < blockRanges_.blocks.x; ++bx) {
+                // Only blocks that the iso surface passes through have cells with triangles
+                const vec2 range = blockRanges_.ranges[blockIndex(size3_t(bx, by, bz))];
+                if (!(range.x < iso && range.y >= iso)) continue;
+
+                const size_t xBegin = bx * blockSize;
+                const size_t xEnd = std::min(xBegin + blockSize, dims.x - 1);
+
+                // The values of the voxels at the lower x-side of the cell, the cells share a
+                // side with the previous cell so only the four values at the upper side are loaded
+                std::array<float, 4> lower;
+                for (size_t r = 0; r < 4; ++r) lower[r] = value(data[rows[r] + xBegin]);
+
+                for (size_t x = xBegin; x < xEnd; ++x) {
+                    ++cellsVisited;
+                    std::array<float, 8> values;
+                    for (size_t r = 0; r < 4; ++r) {
+                        values[2 * r] = lower[r];
+                        values[2 * r + 1] = lower[r] = value(data[rows[r] + x + 1]);
+                    }
 
-                        if (caseId == 5) {
-                            calcTriangle(mesh, iso, voxel2, voxel1, voxel0, voxel1, voxel0, voxel3);
-                            calcTriangle(mesh, iso, voxel2, voxel3, voxel2, voxel1, voxel0, voxel3);
-                        } else {
-                            calcTriangle(mesh, iso, voxel2, voxel1, voxel0, voxel3, voxel0, voxel1);
-                            calcTriangle(mesh, iso, voxel2, voxel3, voxel0, voxel3, voxel2, voxel1);
-                        }
-                    } else if (caseId == 6 || caseId == 9) {
-
-                        if (caseId == 6) {
-                            calcTriangle(mesh, iso, voxel2, voxel0, voxel1, voxel3, voxel1, voxel0);
-                            calcTriangle(mesh, iso, voxel2, voxel0, voxel2, voxel3, voxel1, voxel3);
-                        } else {
-                            calcTriangle(mesh, iso, voxel2, voxel0, voxel1, voxel0, voxel1, voxel3);
-                            calcTriangle(mesh, iso, voxel2, voxel0, voxel1, voxel3, voxel2, voxel3);
-                        }
-                    } else if (caseId == 7 || caseId == 8) {
+                    // Cells with all corners on the same side of the iso value have no triangles
+                    unsigned below = 0;
+                    for (size_t i = 0; i < 8; ++i) below |= (values[i] < iso ? 1u : 0u) << i;
+                    if (below == 0 || below == 0xFF) continue;
+
+                    // The corners are numbered i = x + 2y + 4z within the cell
+                    Cell c;
+                    for (size_t i = 0; i < 8; ++i) {
+                        const size_t cx = x + (i & 1);
+                        const size_t cy = y + ((i >> 1) & 1);
+                        const size_t cz = z + (i >> 2);
+                        c.voxels[i] = {vec3(positions[0][cx], positions[1][cy], positions[2][cz]),
+                                       values[i], rows[i >> 1] + cx};
+                    }
 
-                        if (caseId == 7) {
-                           calcTriangle(mesh, iso, voxel3, voxel1, voxel3, voxel0, voxel3, voxel2);
-                        } else {
-                            calcTriangle(mesh, iso, voxel3, voxel1, voxel3, voxel2, voxel3, voxel0);
+                    // Bit i of a tetrahedron case is set if its voxel i is below the iso value
+                    for (size_t t = 0; t < 6; ++t) {
+                        const auto& tetraCase =
+                            tetrahedra::cellCases[t][tetrahedra::caseId(below, t)];
+                        for (size_t k = 0; k < tetraCase.triangles; ++k) {
+                            const auto& edges = tetraCase.edges[k];
+                            const size_t v0 = calcTriangleVert(mesh, c.voxels[edges[0][0]],
+                                                               c.voxels[edges[0][1]], iso);
+                            const size_t v1 = calcTriangleVert(mesh, c.voxels[edges[1][0]],
+                                                               c.voxels[edges[1][1]], iso);
+                            const size_t v2 = calcTriangleVert(mesh, c.voxels[edges[2][0]],
+                                                               c.voxels[edges[2][1]], iso);
+                            mesh.addTriangle(v0, v1, v2);
                         }
                     }
                 }
@@ -203,54 +256,172 @@ void MarchingTetrahedra::process() {
         }
     }
 
-    mesh_.setData(mesh.toBasicMesh());
+    mesh.releaseEdgeCache();
+    return cellsVisited;
 }
 
-MarchingTetrahedra::MeshHelper::MeshHelper(std::shared_ptr<const Volume> vol)
-    : edgeToVertex_()
-    , vertices_()
-    , mesh_(std::make_shared<BasicMesh>())
-    , indexBuffer_(mesh_->addIndexBuffer(DrawType::Triangles, ConnectivityType::None)) {
-    mesh_->setModelMatrix(vol->getModelMatrix());
-    mesh_->setWorldMatrix(vol->getWorldMatrix());
+MarchingTetrahedra::EdgeCache::EdgeCache(size3_t dims)
+    : dims_(dims), planeSize_(dims.x * dims.y), planes_{none, none}, ids_() {}
+
+std::uint32_t& MarchingTetrahedra::EdgeCache::operator()(size_t i, size_t j) {
+    IVW_ASSERT(i < j, "i should be less than j");
+    if (ids_.empty()) ids_.resize(2 * planeSize_ * 7, none);
+
+    const size_t zi = i / planeSize_;
+    const size_t zj = j / planeSize_;
+    const size_t xi = i % dims_.x;
+    const size_t xj = j % dims_.x;
+
+    // The directions (1,0,0), (0,1,0), (-1,1,0) within the plane and (0,0,1), (0,-1,1),
+    // (1,0,1), (1,-1,1) to the next plane
+    size_t direction;
+    if (zi == zj) {
+        direction = xj > xi ? 0 : (xj == xi ? 1 : 2);
+    } else {
+        const bool sameRow = j - i == planeSize_ + (xj - xi);
+        direction = xj == xi ? (sameRow ? 3 : 4) : (sameRow ? 5 : 6);
+    }
+
+    const size_t slot = zi % 2;
+    auto first = ids_.begin() + slot * planeSize_ * 7;
+    if (planes_[slot] != zi) {
+        std::fill(first, first + planeSize_ * 7, none);
+        planes_[slot] = zi;
+    }
+    return *(first + (i - zi * planeSize_) * 7 + direction);
 }
 
+void MarchingTetrahedra::EdgeCache::release() {
+    ids_ = std::vector<std::uint32_t>();
+    planes_ = {none, none};
+}
+
+MarchingTetrahedra::MeshHelper::MeshHelper(size3_t dims)
+    : edgeCache_(dims), positions_(), normals_(), indices_(), vertexEdges_() {}
+
 void MarchingTetrahedra::MeshHelper::addTriangle(size_t i0, size_t i1, size_t i2) {
     IVW_ASSERT(i0 != i1, "i0 and i1 should not be the same value");
     IVW_ASSERT(i0 != i2, "i0 and i2 should not be the same value");
     IVW_ASSERT(i1 != i2, "i1 and i2 should not be the same value");
 
-    indexBuffer_->add(static_cast<glm::uint32_t>(i0));
-    indexBuffer_->add(static_cast<glm::uint32_t>(i1));
-    indexBuffer_->add(static_cast<glm::uint32_t>(i2));
+    indices_.push_back(static_cast<glm::uint32_t>(i0));
+    indices_.push_back(static_cast<glm::uint32_t>(i1));
+    indices_.push_back(static_cast<glm::uint32_t>(i2));
+    ++statistics_.triangles;
 
-    const auto a = std::get<0>(vertices_[i0]);
-    const auto b = std::get<0>(vertices_[i1]);
-    const auto c = std::get<0>(vertices_[i2]);
+    const auto a = positions_[i0];
+    const auto b = positions_[i1];
+    const auto c = positions_[i2];
 
     const vec3 n = glm::normalize(glm::cross(b - a, c - a));
-    std::get<1>(vertices_[i0]) += n;
-    std::get<1>(vertices_[i1]) += n;
-    std::get<1>(vertices_[i2]) += n;
+    normals_[i0] += n;
+    normals_[i1] += n;
+    normals_[i2] += n;
 }
 
-std::shared_ptr<BasicMesh> MarchingTetrahedra::MeshHelper::toBasicMesh() {
-    for (auto& vertex : vertices_) {
-        std::get<1>(vertex) = glm::normalize(std::get<1>(vertex));
+void MarchingTetrahedra::MeshHelper::append(MeshHelper&& slab, size2_t lower, size2_t upper) {
+    const auto within = [](const std::pair<size_t, size_t>& edge, size2_t plane) {
+        return edge.first >= plane.x && edge.second < plane.y;
+    };
+
+    std::vector<std::uint32_t> slabToMesh(slab.positions_.size());
+    for (size_t v = 0; v < slab.positions_.size(); ++v) {
+        const auto& edge = slab.vertexEdges_[v];
+        if (within(edge, lower)) {
+            const auto id = edgeCache_(edge.first, edge.second);
+            if (id != EdgeCache::none) {
+                // The vertex was created first by the previous slab, keep its position. The slab
+                // counted it as a miss when creating it, count it as a hit instead
+                slabToMesh[v] = id;
+                normals_[id] += slab.normals_[v];
+                ++slab.statistics_.edgeCacheHits;
+                --slab.statistics_.edgeCacheMisses;
+                continue;
+            }
+        }
+        slabToMesh[v] = static_cast<std::uint32_t>(positions_.size());
+        positions_.push_back(slab.positions_[v]);
+        normals_.push_back(slab.normals_[v]);
+    }
+
+    // The edge cache only holds the shared plane, the edges of the vertices are not kept
+    for (size_t v = 0; v < slab.positions_.size(); ++v) {
+        const auto& edge = slab.vertexEdges_[v];
+        if (within(edge, upper)) edgeCache_(edge.first, edge.second) = slabToMesh[v];
     }
-    mesh_->addVertices(vertices_);
-    return mesh_;
+
+    indices_.reserve(indices_.size() + slab.indices_.size());
+    for (const auto i : slab.indices_) {
+        indices_.push_back(slabToMesh[i]);
+    }
+
+    statistics_.triangles += slab.statistics_.triangles;
+    statistics_.edgeCacheHits += slab.statistics_.edgeCacheHits;
+    statistics_.edgeCacheMisses += slab.statistics_.edgeCacheMisses;
+
+    slab.positions_ = std::vector<vec3>();
+    slab.normals_ = std::vector<vec3>();
+    slab.indices_ = std::vector<std::uint32_t>();
+    slab.vertexEdges_ = std::vector<std::pair<size_t, size_t>>();
+    slab.releaseEdgeCache();
+}
+
+std::shared_ptr<Mesh> MarchingTetrahedra::MeshHelper::toMesh(const Volume& volume) {
+    ScopedTimer timer("MeshHelper::toMesh");
+    for (auto& normal : normals_) {
+        normal = glm::normalize(normal);
+    }
+
+    // The same buffers as a BasicMesh, the texture coordinates are the positions
+    auto texCoords = std::make_shared<Buffer<vec3>>();
+    texCoords->getEditableRAMRepresentation()->getDataContainer() = positions_;
+    auto colors = std::make_shared<Buffer<vec4>>();
+    colors->getEditableRAMRepresentation()->getDataContainer().assign(
+        positions_.size(), vec4(0.7f, 0.7f, 0.7f, 1.0f));
+    auto positions = std::make_shared<Buffer<vec3>>();
+    positions->getEditableRAMRepresentation()->getDataContainer() = std::move(positions_);
+    auto normals = std::make_shared<Buffer<vec3>>();
+    normals->getEditableRAMRepresentation()->getDataContainer() = std::move(normals_);
+    auto indices = std::make_shared<IndexBuffer>();
+    indices->getEditableRAMRepresentation()->getDataContainer() = std::move(indices_);
+
+    auto mesh = std::make_shared<Mesh>(DrawType::Triangles, ConnectivityType::None);
+    mesh->addBuffer(BufferType::PositionAttrib, positions);
+    mesh->addBuffer(BufferType::NormalAttrib, normals);
+    mesh->addBuffer(BufferType::TexCoordAttrib, texCoords);
+    mesh->addBuffer(BufferType::ColorAttrib, colors);
+    mesh->addIndices(Mesh::MeshInfo(DrawType::Triangles, ConnectivityType::None), indices);
+    mesh->setModelMatrix(volume.getModelMatrix());
+    mesh->setWorldMatrix(volume.getWorldMatrix());
+
+    positions_ = std::vector<vec3>();
+    normals_ = std::vector<vec3>();
+    indices_ = std::vector<std::uint32_t>();
+    return mesh;
 }
 
 std::uint32_t MarchingTetrahedra::MeshHelper::addVertex(vec3 pos, size_t i, size_t j) {
     IVW_ASSERT(i != j, "i and j should not be the same value");
     if (j < i) std::swap(i, j);
 
-    auto [edgeIt, inserted] = edgeToVertex_.try_emplace(std::make_pair(i, j), vertices_.size());
-    if (inserted) {
-        vertices_.push_back({pos, vec3(0, 0, 0), pos, vec4(0.7f, 0.7f, 0.7f, 1.0f)});
+    auto& id = edgeCache_(i, j);
+    if (id == EdgeCache::none) {
+        id = static_cast<std::uint32_t>(positions_.size());
+        positions_.push_back(pos);
+        normals_.emplace_back(0.0f);
+        vertexEdges_.emplace_back(i, j);
+        ++statistics_.edgeCacheMisses;
+    } else {
+        ++statistics_.edgeCacheHits;
     }
-    return static_cast<std::uint32_t>(edgeIt->second);
+    return id;
+}
+
+void MarchingTetrahedra::MeshHelper::releaseEdgeCache() { edgeCache_.release(); }
+
+const MarchingTetrahedra::MeshHelper::Statistics& MarchingTetrahedra::MeshHelper::getStatistics()
+    const {
+    return statistics_;
 }
 
 }  // namespace inviwo
@@ -6,20 +6,41 @@
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/volumeport.h>
 #include <inviwo/core/ports/meshport.h>
-#include <inviwo/core/datastructures/geometry/basicmesh.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/datastructures/volume/volumeram.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB2_API MarchingTetrahedra : public Processor {
 public:
-    struct HashFunc {
-        static size_t max;
-        size_t operator()(std::pair<size_t, size_t> p) const {
-            size_t asdf;
-            asdf = p.first;
-            asdf += p.second * max;
-            return std::hash<size_t>{}(asdf);
-        }
+    /**
+     * Vertex ids of the edges of the tetrahedra that start at the voxels of two consecutive
+     * z-planes. An edge is stored at the voxel with the lower index, from where it goes in one of
+     * seven directions. The two planes are kept in a ring of two slots and a slot is cleared when
+     * it is first used for another plane, so edges have to be visited in increasing z order.
+     * The memory is allocated on first use.
+     */
+    class EdgeCache {
+    public:
+        static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+        explicit EdgeCache(size3_t dims);
+
+        // The vertex id of the edge between the voxels with 1D-indices i < j, none if unset
+        std::uint32_t& operator()(size_t i, size_t j);
+        // Frees the memory, the cache starts over on the next use
+        void release();
+
+    private:
+        size3_t dims_;
+        size_t planeSize_;
+        std::array<size_t, 2> planes_;  // The z-plane in each slot
+        std::vector<std::uint32_t> ids_;
     };
 
     struct Voxel {
@@ -32,13 +53,13 @@ public:
         Voxel voxels[8];
     };
 
-    struct Tetrahedra {
-        Voxel voxels[4];
-    };
-
     struct MeshHelper {
 
-        MeshHelper(std::shared_ptr<const Volume> vol);
+        /**
+         * A helper for a volume with the given dimensions. The vertices and triangles are kept in
+         * plain vectors, a mesh is only created by toMesh.
+         */
+        explicit MeshHelper(size3_t dims);
 
         /**
          * Adds a vertex to the mesh. The input parameters i and j are the voxel-indices of the two
@@ -53,13 +74,40 @@ public:
          */
         std::uint32_t addVertex(vec3 pos, size_t i, size_t j);
         void addTriangle(size_t i0, size_t i1, size_t i2);
-        std::shared_ptr<BasicMesh> toBasicMesh();
+
+        /**
+         * Appends the vertices and triangles of a helper that extracted the next z-slab. The
+         * slabs share the plane of voxels with 1D-indices in [lower.x, lower.y), vertices on edges
+         * within it were created by both helpers and are merged by adding up their normals. The
+         * vertices on edges within the plane upper are kept for the next call, which is the only
+         * use of the edge cache of a helper that slabs are appended to. The memory of the slab is
+         * freed.
+         */
+        void append(MeshHelper&& slab, size2_t lower, size2_t upper);
+
+        /**
+         * Moves the vertices and triangles into a new mesh with the transformations of volume,
+         * the helper is empty afterwards.
+         */
+        std::shared_ptr<Mesh> toMesh(const Volume& volume);
+        // Frees the edge cache once no more vertices will be added
+        void releaseEdgeCache();
+
+        struct Statistics {
+            size_t triangles = 0;
+            size_t edgeCacheHits = 0;    // addVertex calls that reused an existing vertex
+            size_t edgeCacheMisses = 0;  // addVertex calls that created a vertex
+        };
+        const Statistics& getStatistics() const;
 
     private:
-        std::unordered_map<std::pair<size_t, size_t>, size_t, HashFunc> edgeToVertex_;
-        std::vector<BasicMesh::Vertex> vertices_;
-        std::shared_ptr<BasicMesh> mesh_;
-        std::shared_ptr<IndexBufferRAM> indexBuffer_;
+        Statistics statistics_;
+        EdgeCache edgeCache_;
+        std::vector<vec3> positions_;
+        std::vector<vec3> normals_;  // Sums of the normals of the adjacent triangles
+        std::vector<std::uint32_t> indices_;
+        // The edge of each vertex created by addVertex, only needed until the helper is appended
+        std::vector<std::pair<size_t, size_t>> vertexEdges_;
     };
 
     MarchingTetrahedra();
@@ -73,18 +121,30 @@ public:
     static const ProcessorInfo processorInfo_;
 
 private:
+    /**
+     * Extracts the cells with z in [zBegin, zEnd) of the volume data into mesh. The spatial
+     * positions of the voxels are given per axis. Returns the number of cells visited.
+     */
+    template <typename T>
+    size_t extractSlab(const T* data, size3_t dims,
+                       const std::array<std::vector<float>, 3>& positions, size_t zBegin,
+                       size_t zEnd, float iso, MeshHelper& mesh);
     size_t calcTriangleVert(MeshHelper& mesh, const MarchingTetrahedra::Voxel& voxel0, const MarchingTetrahedra::Voxel& voxel1, const float& iso);
-    void calcTriangle(MarchingTetrahedra::MeshHelper& mesh, const float& iso,
-                                          const MarchingTetrahedra::Voxel& vox0,
-                                          const MarchingTetrahedra::Voxel& vox1,
-                                          const MarchingTetrahedra::Voxel& vox2,
-                                          const MarchingTetrahedra::Voxel& vox3,
-                                          const MarchingTetrahedra::Voxel& vox4,
-                                          const MarchingTetrahedra::Voxel& vox5);
     VolumeInport volume_;
     MeshOutport mesh_;
 
     FloatProperty isoValue_;
+
+    /**
+     * The smallest and largest voxel value, as (min, max), of each block of 8^3 cells. Blocks
+     * that do not contain the iso value are skipped, so a change of the iso value only visits the
+     * cells near the surface. Built on the first process() after the volume has changed.
+     */
+    struct BlockRanges {
+        size3_t blocks{0};
+        std::vector<vec2> ranges;
+    };
+    BlockRanges blockRanges_;
 };
 
 }  // namespace inviwo
@@ -0,0 +1,419 @@
+/*
+ * Headless throughput harness for the CPU processors of the TNM067 labs: ImageMappingCPU,
+ * ImageUpsampler, ImageToHeightfield, HydrogenGenerator and MarchingTetrahedra. Every processor is
+ * fed generated images or volumes of increasing size through its inports, without a processor
+ * network, a GUI or an OpenGL context. Only the InviwoApplication is created, for the thread pool
+ * that the processors use.
+ *
+ * A new processor is created for every run, so no run reuses the caches of the previous one, and
+ * only process() is timed. The outputs of every run are checked, the harness fails if a processor
+ * produces no or wrongly sized output.
+ *
+ * Every case is written to stdout as one line of JSON with the wall times of the runs in seconds,
+ * the throughput in pixels or voxels per second (and triangles per second for the processors
+ * that output meshes) and the peak resident set size of the case in KiB. On Linux the peak is
+ * reset before every case, elsewhere it is the peak of the process so far.
+ *
+ *     tnm067-processor-throughput [runs = 5] [sizes = 3]
+ *
+ * runs times every case and sizes limits how many of the input sizes of every processor are run,
+ * from the smallest. The target is defined in tests/benchmarks/CMakeLists.txt, which is added by
+ *
+ *     add_subdirectory(tests/benchmarks)
+ *
+ * in the CMakeLists.txt of the tnm067lab2 module. Run it in a release build, e.g.
+ *
+ *     cmake --build . --config Release --target tnm067-processor-throughput
+ *     tnm067-processor-throughput 5 3 > throughput.json
+ */
+
+#include <modules/tnm067lab1/processors/imagemappingcpu.h>
+#include <modules/tnm067lab1/processors/imagetoheightfield.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <modules/tnm067lab2/processors/hydrogengenerator.h>
+#include <modules/tnm067lab2/processors/marchingtetrahedra.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/datastructures/image/image.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeram.h>
+#include <inviwo/core/ports/imageport.h>
+#include <inviwo/core/ports/volumeport.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/util/consolelogger.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/logcentral.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace inviwo;
+
+namespace {
+
+void check(bool condition, const std::string& message) {
+    if (!condition) throw Exception(message, IVW_CONTEXT_CUSTOM("ProcessorThroughput"));
+}
+
+// Resets the peak resident set size, only supported on Linux
+void resetPeakMemory() {
+#ifdef __linux__
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+size_t peakMemoryKiB() {
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<size_t>(counters.PeakWorkingSetSize / 1024);
+#else
+#ifdef __linux__
+    // VmHWM follows the resets of resetPeakMemory, ru_maxrss does not
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::stoul(line.substr(6));
+    }
+#endif
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss / 1024);
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Smooth test data with values in [0, 1], the same for every run
+float imageValue(size2_t pos, size2_t dims) {
+    const vec2 p = vec2(pos) / vec2(dims) * 20.0f;
+    return 0.5f + 0.25f * (std::sin(p.x) + std::cos(1.3f * p.y));
+}
+
+float volumeValue(size3_t pos, size3_t dims) {
+    const vec3 p = vec3(pos) / vec3(dims - size3_t(1)) * 6.0f;
+    return 0.5f + 0.25f * (std::sin(p.x) + std::sin(p.y) * std::cos(p.z));
+}
+
+std::shared_ptr<Image> createImage(size2_t dims, bool uint8) {
+    auto image = std::make_shared<Image>(
+        dims, uint8 ? static_cast<const DataFormatBase*>(DataUInt8::get()) : DataFloat32::get());
+    auto layer = image->getColorLayer()->getEditableRepresentation<LayerRAM>();
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const float v = imageValue(size2_t(x, y), dims);
+            if (uint8) {
+                static_cast<LayerRAMPrecision<glm::u8>*>(layer)->getDataTyped()[x + y * dims.x] =
+                    static_cast<glm::u8>(std::round(v * 255.0f));
+            } else {
+                static_cast<LayerRAMPrecision<float>*>(layer)->getDataTyped()[x + y * dims.x] = v;
+            }
+        }
+    }
+    return image;
+}
+
+std::shared_ptr<Volume> createVolume(size3_t dims) {
+    auto volume = std::make_shared<Volume>(dims, DataFloat32::get());
+    auto data = static_cast<float*>(volume->getEditableRepresentation<VolumeRAM>()->getData());
+    for (size_t z = 0; z < dims.z; ++z) {
+        for (size_t y = 0; y < dims.y; ++y) {
+            for (size_t x = 0; x < dims.x; ++x) {
+                data[x + dims.x * (y + dims.y * z)] = volumeValue(size3_t(x, y, z), dims);
+            }
+        }
+    }
+    return volume;
+}
+
+/*
+ * Outports holding the generated inputs of a run, connected to the inports of the processor. The
+ * connections are removed on destruction, so the processor has to outlive the sources.
+ */
+class Sources {
+public:
+    Sources() = default;
+    Sources(const Sources&) = delete;
+    Sources& operator=(const Sources&) = delete;
+    ~Sources() {
+        for (auto& [inport, outport] : connections_) inport->disconnectFrom(outport.get());
+    }
+
+    void connect(Processor& processor, const std::string& inport,
+                 std::shared_ptr<const Image> image) {
+        auto outport = std::make_unique<ImageOutport>("source");
+        outport->setData(image);
+        connect(processor, inport, std::move(outport));
+    }
+    void connect(Processor& processor, const std::string& inport,
+                 std::shared_ptr<const Volume> volume) {
+        auto outport = std::make_unique<VolumeOutport>("source");
+        outport->setData(volume);
+        connect(processor, inport, std::move(outport));
+    }
+
+private:
+    void connect(Processor& processor, const std::string& inport,
+                 std::unique_ptr<Outport> outport) {
+        auto port = processor.getInport(inport);
+        check(port != nullptr, "No inport " + inport);
+        port->connectTo(outport.get());
+        connections_.emplace_back(port, std::move(outport));
+    }
+
+    std::vector<std::pair<Inport*, std::unique_ptr<Outport>>> connections_;
+};
+
+template <typename T>
+T& property(Processor& processor, const std::string& identifier) {
+    auto property = dynamic_cast<T*>(processor.getPropertyByIdentifier(identifier, true));
+    check(property != nullptr, "No property " + identifier);
+    return *property;
+}
+
+void select(Processor& processor, const std::string& identifier, const std::string& option) {
+    property<BaseOptionProperty>(processor, identifier).setSelectedIdentifier(option);
+}
+
+template <typename T>
+std::shared_ptr<const T> outputData(Processor& processor, const std::string& outport) {
+    auto port = dynamic_cast<DataOutport<T>*>(processor.getOutport(outport));
+    check(port != nullptr, "No outport " + outport);
+    return port->getData();
+}
+
+size_t numTriangles(const Mesh& mesh) {
+    size_t triangles = 0;
+    for (size_t i = 0; i < mesh.getNumberOfIndicies(); ++i) {
+        triangles += mesh.getIndices(i)->getSize() / 3;
+    }
+    return triangles;
+}
+
+struct Case {
+    std::string processor;
+    std::string config;
+    std::vector<size_t> dims;
+    size_t items;      // Number of pixels or voxels processed per run
+    std::string unit;  // "pixels" or "voxels"
+    // Creates and sets up a processor and connects its inputs to sources
+    std::function<std::unique_ptr<Processor>(Sources&)> create;
+    // Checks the outputs of a run and returns the number of triangles output, if any
+    std::function<size_t(Processor&)> check;
+};
+
+void run(const Case& c, size_t runs) {
+    resetPeakMemory();
+
+    std::vector<double> seconds;
+    size_t triangles = 0;
+    for (size_t i = 0; i < runs; ++i) {
+        std::unique_ptr<Processor> processor;
+        Sources sources;  // Destroyed first, while the processor is still alive
+        processor = c.create(sources);
+        const auto start = std::chrono::steady_clock::now();
+        processor->process();
+        const auto end = std::chrono::steady_clock::now();
+        seconds.push_back(std::chrono::duration<double>(end - start).count());
+        triangles = c.check(*processor);
+    }
+    const size_t peakKiB = peakMemoryKiB();
+
+    std::sort(seconds.begin(), seconds.end());
+    const double median = seconds[seconds.size() / 2];
+
+    std::ostringstream json;
+    json << "{\"processor\":\"" << c.processor << "\",\"config\":\"" << c.config
+         << "\",\"dims\":[";
+    for (size_t i = 0; i < c.dims.size(); ++i) json << (i > 0 ? "," : "") << c.dims[i];
+    json << "],\"runs\":" << runs << ",\"seconds\":{\"min\":" << seconds.front()
+         << ",\"median\":" << median << ",\"max\":" << seconds.back() << "},\"" << c.unit
+         << "\":" << c.items << ",\"" << c.unit << "PerSecond\":" << c.items / median;
+    if (triangles > 0) {
+        json << ",\"triangles\":" << triangles << ",\"trianglesPerSecond\":" << triangles / median;
+    }
+    json << ",\"peakRssKiB\":" << peakKiB << "}";
+    std::cout << json.str() << std::endl;
+}
+
+std::vector<Case> imageMappingCases(size_t size) {
+    std::vector<Case> cases;
+    for (const bool uint8 : {false, true}) {
+        const size2_t dims(size);
+        auto image = createImage(dims, uint8);
+        cases.push_back(
+            {"ImageMappingCPU", uint8 ? "uint8" : "float32", {dims.x, dims.y}, dims.x * dims.y,
+             "pixels",
+             [image](Sources& sources) {
+                 auto p = std::make_unique<ImageMappingCPU>();
+                 sources.connect(*p, "inport", image);
+                 property<IntSizeTProperty>(*p, "numColors").set(5);
+                 return p;
+             },
+             [dims](Processor& p) {
+                 auto image = outputData<Image>(p, "outport");
+                 check(image && image->getDimensions() == dims, "ImageMappingCPU output size");
+                 return size_t{0};
+             }});
+    }
+    return cases;
+}
+
+std::vector<Case> upsamplerCases(size_t size) {
+    std::vector<Case> cases;
+    const size2_t inputDims(size / 4);
+    const size2_t dims(size);
+    auto image = createImage(inputDims, false);
+    for (const std::string method : {"piecewiseconstant", "bilinear", "quadratic", "barycentric"}) {
+        cases.push_back(
+            {"ImageUpsampler", method, {dims.x, dims.y}, dims.x * dims.y, "pixels",
+             [image, method, dims](Sources& sources) {
+                 auto p = std::make_unique<ImageUpsampler>();
+                 sources.connect(*p, "inport", image);
+                 select(*p, "interpolationMethod", method);
+                 auto outport = dynamic_cast<ImageOutport*>(p->getOutport("outport"));
+                 check(outport != nullptr, "No outport outport");
+                 outport->setDimensions(dims);
+                 return p;
+             },
+             [dims](Processor& p) {
+                 auto image = outputData<Image>(p, "outport");
+                 check(image && image->getDimensions() == dims, "ImageUpsampler output size");
+                 return size_t{0};
+             }});
+    }
+    return cases;
+}
+
+std::vector<Case> heightfieldCases(size_t size) {
+    std::vector<Case> cases;
+    const size2_t dims(size);
+    auto image = createImage(dims, false);
+    for (const std::string mode : {"bars", "surface", "chunkedSurface"}) {
+        cases.push_back(
+            {"ImageToHeightfield", mode, {dims.x, dims.y}, dims.x * dims.y, "pixels",
+             [image, mode](Sources& sources) {
+                 auto p = std::make_unique<ImageToHeightfield>();
+                 sources.connect(*p, "imageInport", image);
+                 select(*p, "meshMode", mode);
+                 return p;
+             },
+             [mode](Processor& p) {
+                 size_t triangles = 0;
+                 if (mode != "chunkedSurface") {
+                     auto mesh = outputData<Mesh>(p, "meshOutport");
+                     check(mesh != nullptr, "ImageToHeightfield has no mesh");
+                     triangles = numTriangles(*mesh);
+                 } else {
+                     using Chunks = std::vector<std::shared_ptr<Mesh>>;
+                     auto chunks = outputData<Chunks>(p, "chunksOutport");
+                     check(chunks && !chunks->empty(), "ImageToHeightfield has no chunks");
+                     for (const auto& chunk : *chunks) triangles += numTriangles(*chunk);
+                 }
+                 check(triangles > 0, "ImageToHeightfield output has no triangles");
+                 return triangles;
+             }});
+    }
+    return cases;
+}
+
+std::vector<Case> hydrogenCases(size_t size) {
+    std::vector<Case> cases;
+    const size3_t dims(size);
+    for (const std::string precision : {"double", "fast"}) {
+        cases.push_back(
+            {"HydrogenGenerator", precision, {dims.x, dims.y, dims.z}, dims.x * dims.y * dims.z,
+             "voxels",
+             [size, precision](Sources&) {
+                 auto p = std::make_unique<HydrogenGenerator>();
+                 property<IntSizeTProperty>(*p, "size_").set(size);
+                 select(*p, "precision", precision);
+                 return p;
+             },
+             [dims](Processor& p) {
+                 auto volume = outputData<Volume>(p, "volume");
+                 check(volume && volume->getDimensions() == dims, "HydrogenGenerator output size");
+                 return size_t{0};
+             }});
+    }
+    return cases;
+}
+
+std::vector<Case> marchingTetrahedraCases(size_t size) {
+    const size3_t dims(size);
+    auto volume = createVolume(dims);
+    return {{"MarchingTetrahedra", "iso 0.5", {dims.x, dims.y, dims.z}, dims.x * dims.y * dims.z,
+             "voxels",
+             [volume](Sources& sources) {
+                 auto p = std::make_unique<MarchingTetrahedra>();
+                 sources.connect(*p, "volume", volume);
+                 property<FloatProperty>(*p, "isoValue").set(0.5f);
+                 return p;
+             },
+             [](Processor& p) {
+                 auto mesh = outputData<Mesh>(p, "mesh");
+                 check(mesh != nullptr, "MarchingTetrahedra has no mesh");
+                 const size_t triangles = numTriangles(*mesh);
+                 check(triangles > 0, "MarchingTetrahedra output has no triangles");
+                 return triangles;
+             }}};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    LogCentral::init();
+    auto logger = std::make_shared<ConsoleLogger>();
+    LogCentral::getPtr()->setVerbosity(LogVerbosity::Error);
+    LogCentral::getPtr()->registerLogger(logger);
+
+    const size_t runs = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 5;
+    const size_t numSizes = argc > 2 ? std::min(std::max(std::atoi(argv[2]), 1), 3) : 3;
+
+    // The processors use the thread pool of the application
+    InviwoApplication app(argc, argv, "TNM067 Processor Throughput");
+
+    // The input sizes along each axis, the output size for ImageUpsampler
+    using Cases = std::function<std::vector<Case>(size_t)>;
+    const std::vector<std::pair<Cases, std::vector<size_t>>> processors{
+        {imageMappingCases, {256, 1024, 4096}},
+        {upsamplerCases, {256, 1024, 4096}},
+        {heightfieldCases, {128, 512, 2048}},
+        {hydrogenCases, {64, 128, 256}},
+        {marchingTetrahedraCases, {32, 64, 128}}};
+
+    try {
+        for (const auto& [cases, sizes] : processors) {
+            for (size_t i = 0; i < numSizes; ++i) {
+                for (const auto& c : cases(sizes[i])) run(c, runs);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
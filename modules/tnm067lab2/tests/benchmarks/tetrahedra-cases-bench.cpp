@@ -0,0 +1,226 @@
+/*
+ * Micro-benchmark of the tetrahedron case dispatch of MarchingTetrahedra. The case table
+ * tetrahedra::cellCases, which MarchingTetrahedra uses, is compared with the chain of branches on
+ * the case that it replaced. The cells are taken from a 32^3 volume of uniform noise, where the
+ * cases of consecutive cells are independent and the branches are hard to predict, and from a
+ * smooth volume, where the surface changes slowly and the branches are easy to predict.
+ *
+ * Only the cells with corners on both sides of the iso value are timed, their values are gathered
+ * before the timing. Both kernels interpolate the same triangle vertices along the cell edges, so
+ * the difference between them is the dispatch. Every benchmark reports ns/cell and the number of
+ * triangles per cell.
+ *
+ * The branch misses are not measured by the benchmark itself. Compare them with perf, once per
+ * kernel on the noisy volume:
+ *
+ *     perf stat -e branches,branch-misses tnm067lab2-benchmark --benchmark_filter=table/noise
+ *     perf stat -e branches,branch-misses tnm067lab2-benchmark --benchmark_filter=branches/noise
+ *
+ * The setup of both runs is the same, so the difference of the counts comes from the kernels. If
+ * Google Benchmark is built with libpfm, --benchmark_perf_counters=BRANCH-MISSES reports the
+ * misses of the timed loop of every benchmark instead.
+ *
+ * The benchmarks are built as tnm067lab2-benchmark when IVW_TEST_BENCHMARKS is enabled, see
+ * tests/benchmarks/CMakeLists.txt. Run them in a release build.
+ */
+
+#include <modules/tnm067lab2/utils/tetrahedracases.h>
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <benchmark/benchmark.h>
+#include <warn/pop>
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+constexpr unsigned seed = 67;
+// Small enough for the triangles of the noisy volume to stay in the caches
+constexpr size_t volumeSize = 32;
+constexpr float iso = 0.5f;
+
+enum class Data { Noise, Smooth };
+
+struct ActiveCell {
+    unsigned below;  // Bit i is set if corner i is below the iso value
+    std::array<float, 8> values;
+};
+
+// The cells of a volume that have triangles, with corners numbered x + 2y + 4z
+std::vector<ActiveCell> activeCells(Data data) {
+    const size_t n = volumeSize;
+    std::vector<float> volume(n * n * n);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t z = 0; z < n; ++z) {
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const float p = 6.0f / (n - 1);
+                volume[x + n * (y + n * z)] =
+                    data == Data::Noise
+                        ? dist(rng)
+                        : 0.5f + 0.25f * (std::sin(p * x) + std::sin(p * y) * std::cos(p * z));
+            }
+        }
+    }
+
+    std::vector<ActiveCell> cells;
+    for (size_t z = 0; z + 1 < n; ++z) {
+        for (size_t y = 0; y + 1 < n; ++y) {
+            for (size_t x = 0; x + 1 < n; ++x) {
+                ActiveCell cell{0, {}};
+                for (size_t i = 0; i < 8; ++i) {
+                    cell.values[i] =
+                        volume[x + (i & 1) + n * (y + ((i >> 1) & 1) + n * (z + (i >> 2)))];
+                    cell.below |= (cell.values[i] < iso ? 1u : 0u) << i;
+                }
+                if (cell.below != 0 && cell.below != 0xFF) cells.push_back(cell);
+            }
+        }
+    }
+    return cells;
+}
+
+// Stands in for the mesh, holds the interpolation weight of each triangle vertex along its edge
+struct Triangles {
+    std::vector<float> vertices;
+
+    void add(const ActiveCell& cell, unsigned a0, unsigned a1, unsigned b0, unsigned b1,
+             unsigned c0, unsigned c1) {
+        vertices.push_back(vertex(cell, a0, a1));
+        vertices.push_back(vertex(cell, b0, b1));
+        vertices.push_back(vertex(cell, c0, c1));
+    }
+
+    static float vertex(const ActiveCell& cell, unsigned i, unsigned j) {
+        return (iso - cell.values[i]) / (cell.values[j] - cell.values[i]);
+    }
+};
+
+void tableKernel(const ActiveCell& cell, Triangles& triangles) {
+    for (size_t t = 0; t < 6; ++t) {
+        const auto& tetraCase = tetrahedra::cellCases[t][tetrahedra::caseId(cell.below, t)];
+        for (size_t k = 0; k < tetraCase.triangles; ++k) {
+            const auto& e = tetraCase.edges[k];
+            triangles.add(cell, e[0][0], e[0][1], e[1][0], e[1][1], e[2][0], e[2][1]);
+        }
+    }
+}
+
+// The chain of branches that MarchingTetrahedra used before the case table
+void branchKernel(const ActiveCell& cell, Triangles& triangles) {
+    for (const auto& ids : tetrahedra::ids) {
+        const auto tri = [&](unsigned a0, unsigned a1, unsigned b0, unsigned b1, unsigned c0,
+                             unsigned c1) {
+            triangles.add(cell, ids[a0], ids[a1], ids[b0], ids[b1], ids[c0], ids[c1]);
+        };
+
+        int caseId = 0;
+        if (cell.values[ids[0]] < iso) caseId |= 1;
+        if (cell.values[ids[1]] < iso) caseId |= 2;
+        if (cell.values[ids[2]] < iso) caseId |= 4;
+        if (cell.values[ids[3]] < iso) caseId |= 8;
+
+        if (caseId == 1 || caseId == 14) {
+            if (caseId == 1) {
+                tri(0, 1, 0, 3, 0, 2);
+            } else {
+                tri(0, 1, 0, 2, 0, 3);
+            }
+        } else if (caseId == 2 || caseId == 13) {
+            if (caseId == 2) {
+                tri(1, 0, 1, 2, 1, 3);
+            } else {
+                tri(1, 0, 1, 3, 1, 2);
+            }
+        } else if (caseId == 3 || caseId == 12) {
+            if (caseId == 3) {
+                tri(1, 2, 1, 3, 0, 3);
+                tri(1, 2, 0, 3, 0, 2);
+            } else {
+                tri(1, 2, 0, 3, 1, 3);
+                tri(1, 2, 0, 2, 0, 3);
+            }
+        } else if (caseId == 4 || caseId == 11) {
+            if (caseId == 4) {
+                tri(2, 3, 2, 1, 2, 0);
+            } else {
+                tri(2, 3, 2, 0, 2, 1);
+            }
+        } else if (caseId == 5 || caseId == 10) {
+            if (caseId == 5) {
+                tri(2, 1, 0, 1, 0, 3);
+                tri(2, 3, 2, 1, 0, 3);
+            } else {
+                tri(2, 1, 0, 3, 0, 1);
+                tri(2, 3, 0, 3, 2, 1);
+            }
+        } else if (caseId == 6 || caseId == 9) {
+            if (caseId == 6) {
+                tri(2, 0, 1, 3, 1, 0);
+                tri(2, 0, 2, 3, 1, 3);
+            } else {
+                tri(2, 0, 1, 0, 1, 3);
+                tri(2, 0, 1, 3, 2, 3);
+            }
+        } else if (caseId == 7 || caseId == 8) {
+            if (caseId == 7) {
+                tri(3, 1, 3, 0, 3, 2);
+            } else {
+                tri(3, 1, 3, 2, 3, 0);
+            }
+        }
+    }
+}
+
+template <typename Kernel>
+void extract(const std::vector<ActiveCell>& cells, Kernel kernel, Triangles& triangles) {
+    triangles.vertices.clear();
+    for (const auto& cell : cells) kernel(cell, triangles);
+}
+
+template <typename Kernel>
+void BM_TetrahedraCases(benchmark::State& state, Kernel kernel, Data data) {
+    const auto cells = activeCells(data);
+
+    // Both kernels have to emit the same triangles, in the same order and with the same winding
+    Triangles table;
+    Triangles branches;
+    extract(cells, tableKernel, table);
+    extract(cells, branchKernel, branches);
+    if (table.vertices != branches.vertices) {
+        state.SkipWithError("The table and the branches emit different triangles");
+        return;
+    }
+
+    // The vertices are reused by every iteration, like the vectors of MarchingTetrahedra they
+    // only grow in the first one
+    Triangles triangles;
+    for (auto _ : state) {
+        extract(cells, kernel, triangles);
+        benchmark::DoNotOptimize(triangles.vertices.data());
+        benchmark::ClobberMemory();
+    }
+
+    const double numCells = static_cast<double>(state.iterations()) * cells.size();
+    state.SetItemsProcessed(static_cast<int64_t>(numCells));
+    state.counters["ns/cell"] = benchmark::Counter(
+        numCells * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["triangles/cell"] =
+        static_cast<double>(table.vertices.size() / 3) / cells.size();
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_TetrahedraCases, table/noise, tableKernel, Data::Noise);
+BENCHMARK_CAPTURE(BM_TetrahedraCases, branches/noise, branchKernel, Data::Noise);
+BENCHMARK_CAPTURE(BM_TetrahedraCases, table/smooth, tableKernel, Data::Smooth);
+BENCHMARK_CAPTURE(BM_TetrahedraCases, branches/smooth, branchKernel, Data::Smooth);
+
+}  // namespace inviwo
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <modules/tnm067lab2/tnm067lab2moduledefine.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace inviwo {
+
+namespace tetrahedra {
+
+// The split of a cell into six tetrahedra, as cell corners numbered x + 2y + 4z
+inline constexpr std::uint8_t ids[6][4] = {{0, 1, 2, 5}, {1, 3, 2, 5}, {3, 2, 5, 7},
+                                           {0, 2, 4, 5}, {6, 4, 2, 5}, {6, 7, 5, 2}};
+
+/*
+ * The triangles of the tetrahedron cases 0 to 7, bit i of a case is set if voxel i of the
+ * tetrahedron is below the iso value. Each triangle vertex lies on the edge between the two given
+ * voxels. Case 15 - k has the same triangles as case k with the opposite winding.
+ */
+inline constexpr std::uint8_t caseTriangleCount[8] = {0, 1, 1, 2, 1, 2, 2, 1};
+inline constexpr std::uint8_t caseTriangles[8][2][3][2] = {
+    {},
+    {{{0, 1}, {0, 3}, {0, 2}}},
+    {{{1, 0}, {1, 2}, {1, 3}}},
+    {{{1, 2}, {1, 3}, {0, 3}}, {{1, 2}, {0, 3}, {0, 2}}},
+    {{{2, 3}, {2, 1}, {2, 0}}},
+    {{{2, 1}, {0, 1}, {0, 3}}, {{2, 3}, {2, 1}, {0, 3}}},
+    {{{2, 0}, {1, 3}, {1, 0}}, {{2, 0}, {2, 3}, {1, 3}}},
+    {{{3, 1}, {3, 0}, {3, 2}}},
+};
+
+// The triangles of one case of one of the tetrahedra, with the edges given as cell corners
+struct CellCase {
+    std::uint8_t triangles;
+    std::uint8_t edges[2][3][2];
+};
+
+constexpr std::array<std::array<CellCase, 16>, 6> makeCellCases() {
+    std::array<std::array<CellCase, 16>, 6> cases{};
+    for (size_t t = 0; t < 6; ++t) {
+        for (size_t caseId = 0; caseId < 16; ++caseId) {
+            const bool flip = caseId > 7;
+            const size_t base = flip ? 15 - caseId : caseId;
+            auto& cellCase = cases[t][caseId];
+            cellCase.triangles = caseTriangleCount[base];
+            for (size_t k = 0; k < cellCase.triangles; ++k) {
+                for (size_t v = 0; v < 3; ++v) {
+                    // Swapping the last two vertices reverses the winding
+                    const size_t source = flip && v > 0 ? 3 - v : v;
+                    const auto& edge = caseTriangles[base][k][source];
+                    cellCase.edges[k][v][0] = ids[t][edge[0]];
+                    cellCase.edges[k][v][1] = ids[t][edge[1]];
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+/**
+ * The triangles of every case of every tetrahedron of a cell, indexed by tetrahedron and case.
+ * Looking up the case replaces a chain of branches on the case, which are hard to predict for
+ * noisy data.
+ */
+inline constexpr auto cellCases = makeCellCases();
+
+// The tetrahedron case of tetrahedron t, given the bits of the cell corners below the iso value
+constexpr unsigned caseId(unsigned below, size_t t) {
+    return ((below >> ids[t][0]) & 1u) | ((below >> ids[t][1]) & 1u) << 1 |
+           ((below >> ids[t][2]) & 1u) << 2 | ((below >> ids[t][3]) & 1u) << 3;
+}
+
+}  // namespace tetrahedra
+
+}  // namespace inviwo
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <modules/tnm067lab2/tnm067lab2moduledefine.h>
+#include <modules/tnm067lab1/utils/parallel.h>
+#include <inviwo/core/util/glm.h>
+#include <inviwo/core/util/indexmapper.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * The smallest and largest value seen so far. An empty range has min > max and leaves any
+ * other range unchanged when merged into it.
+ */
+template <typename T>
+struct ValueRange {
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+
+    void add(T value) {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    void add(const T* values, size_t count) {
+        T lo = min;
+        T hi = max;
+        for (size_t i = 0; i < count; ++i) {
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+        min = lo;
+        max = hi;
+    }
+    void merge(const ValueRange& other) {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    bool empty() const { return min > max; }
+    dvec2 toDvec2() const { return dvec2(min, max); }
+};
+
+/**
+ * Runs callback(job, range) for the jobs 0 to jobs - 1 in parallel. Each job adds the values it
+ * generates to its own range, so no synchronization is needed, and the ranges are merged once all
+ * jobs are done. This gives the range of a generated volume without a second pass over the data,
+ * which matters for volumes much larger than the caches.
+ */
+template <typename T, typename Callback>
+ValueRange<T> generateWithStatistics(size_t jobs, Callback callback) {
+    std::vector<ValueRange<T>> ranges(jobs);
+    util::forEachIndexParallel(jobs, [&](size_t job) {
+        // Adjacent ranges share cache lines, so a job accumulates into a range on its own stack
+        // and stores it once
+        ValueRange<T> range;
+        callback(job, range);
+        ranges[job] = range;
+    });
+
+    ValueRange<T> range;
+    for (const auto& r : ranges) range.merge(r);
+    return range;
+}
+
+/**
+ * Fills data, a volume of the given dimensions, with generator(pos) for every voxel position. The
+ * z slices are generated in parallel. Returns the range of the generated values.
+ */
+template <typename T, typename Generator>
+ValueRange<T> generateVolume(T* data, size3_t dims, Generator generator) {
+    const util::IndexMapper3D index(dims);
+    return generateWithStatistics<T>(dims.z, [&](size_t z, ValueRange<T>& range) {
+        // Kept in locals, which the stores to data can not alias, so they can stay in registers
+        T min = range.min;
+        T max = range.max;
+        for (size_t y = 0; y < dims.y; ++y) {
+            for (size_t x = 0; x < dims.x; ++x) {
+                const size3_t pos(x, y, z);
+                const T value = generator(pos);
+                data[index(pos)] = value;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+        }
+        range.min = min;
+        range.max = max;
+    });
+}
+
+}  // namespace util
+
+}  // namespace inviwo